@@ -0,0 +1,41 @@
+# - Find Zstd 
+# Find the zstd compression library and includes
+#
+#  ZSTD_INCLUDE_DIR - where to find zstd.h, etc.
+#  ZSTD_LIBRARIES   - List of libraries when using zstd.
+#  ZSTD_FOUND       - True if zstd found.
+
+IF(ZSTD_USE_STATIC)
+  MESSAGE(STATUS "ZSTD_USE_STATIC: ON")
+ELSE()
+  MESSAGE(STATUS "ZSTD_USE_STATIC: OFF")
+ENDIF(ZSTD_USE_STATIC)
+
+FIND_PATH(ZSTD_INCLUDE_DIR zstd.h PATHS
+  /usr/include
+  /opt/local/include
+  /usr/local/include
+)
+IF(ZSTD_USE_STATIC)
+  SET(ZSTD_NAMES ${ZSTD_NAMES} libzstd.a)
+ELSE()
+  SET(ZSTD_NAMES ${ZSTD_NAMES} zstd libzstd)
+ENDIF()
+
+FIND_LIBRARY(ZSTD_LIBRARIES NAMES ${ZSTD_NAMES} PATHS
+  /usr/local/lib
+  /opt/local/lib
+  /usr/lib
+)
+
+IF(ZSTD_LIBRARIES)
+  GET_FILENAME_COMPONENT(ZSTD_LIBRARY_DIR ${ZSTD_LIBRARIES} DIRECTORY)
+ENDIF()
+
+# handle the QUIETLY and REQUIRED arguments and set ZSTD_FOUND to TRUE if
+# all listed variables are TRUE
+include(FindPackageHandleStandardArgs)
+FIND_PACKAGE_HANDLE_STANDARD_ARGS(Zstd
+                                  REQUIRED_VARS ZSTD_LIBRARIES ZSTD_LIBRARY_DIR ZSTD_INCLUDE_DIR
+                                  VERSION_VAR ZSTD_VERSION_STRING)
+MARK_AS_ADVANCED(ZSTD_INCLUDE_DIR)
@@ -1,5 +1,5 @@
 import numpy as np
-from .core import Point, Box,  Polygon
+from .core import Point, Box,  Polygon, PreparedPolygon
 from .core import int64, string
 
 #: Numpy data type thar handle geohash points
@@ -1,10 +1,30 @@
-from typing import List
+from typing import List, overload
 import numpy
 from . import storage
 from . import int64
 from . import string
 
 
+def get_num_threads() -> int:
+    ...
+
+
+def kernel() -> str:
+    ...
+
+
+def kernels() -> List[str]:
+    ...
+
+
+def set_kernel(name: str) -> None:
+    ...
+
+
+def set_num_threads(num_threads: int) -> None:
+    ...
+
+
 class Point:
     def __init__(self, lng: float = 0, lat: float = 0) -> None:
         ...
@@ -35,9 +55,23 @@ class Box:
     def __repr__(self) -> str:
         ...
 
+    @overload
     def contains(self, point: Point) -> bool:
         ...
 
+    @overload
+    def contains(self,
+                 points: numpy.ndarray[Point],
+                 num_threads: int = 0) -> numpy.ndarray[numpy.bool_]:
+        ...
+
+    @overload
+    def contains(self,
+                 lng: numpy.ndarray,
+                 lat: numpy.ndarray,
+                 num_threads: int = 0) -> numpy.ndarray[numpy.bool_]:
+        ...
+
     @property
     def max_corner(self) -> Point:
         ...
@@ -75,3 +109,28 @@ class Polygon:
 
     def envelope(self) -> Box:
         ...
+
+
+class PreparedPolygon:
+    def __init__(self, polygon: Polygon) -> None:
+        ...
+
+    def envelope(self) -> Box:
+        ...
+
+    @overload
+    def contains(self, point: Point) -> bool:
+        ...
+
+    @overload
+    def contains(self,
+                 points: numpy.ndarray[Point],
+                 num_threads: int = 0) -> numpy.ndarray[numpy.bool_]:
+        ...
+
+    @overload
+    def contains(self,
+                 lng: numpy.ndarray,
+                 lat: numpy.ndarray,
+                 num_threads: int = 0) -> numpy.ndarray[numpy.bool_]:
+        ...
@@ -39,7 +39,7 @@ class Base32 {
     auto it = buffer;
     while (it != buffer + count && *it) {
       hash = (hash << 5U) |
-             static_cast<uint64_t>(decode_[static_cast<size_t>(*(it++))]);
+             static_cast<uint64_t>(decode_[static_cast<uint8_t>(*(it++))]);
     }
     return std::make_tuple(hash, static_cast<uint32_t>(it - buffer));
   }
@@ -61,7 +61,7 @@ class Base32 {
 
   // Reports whether byte is part of the encoding.
   [[nodiscard]] inline auto validate_byte(const char byte) const -> bool {
-    return decode_[static_cast<size_t>(byte)] != Base32::kInvalid_;
+    return decode_[static_cast<uint8_t>(byte)] != Base32::kInvalid_;
   }
 };
 
@@ -0,0 +1,31 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define GEOHASH_X86_64
+#endif
+
+#if defined(GEOHASH_X86_64) && !defined(_WIN32)
+// Compiles a function for the given instruction set so that it can use the
+// corresponding intrinsics. MSVC does not require it.
+#define GEOHASH_TARGET(isa) __attribute__((target(isa)))
+// Inlines all the calls made by a function. The functions compiled for
+// another instruction set are only inlined this way.
+#define GEOHASH_FLATTEN __attribute__((flatten))
+#else
+#define GEOHASH_TARGET(isa)
+#define GEOHASH_FLATTEN
+#endif
+
+// Detection of the instruction sets supported by the CPU.
+namespace geohash::cpu {
+
+// Returns true if the CPU supports Bit Manipulation Instruction Set 2 (BMI2)
+[[nodiscard]] auto has_bmi2() noexcept -> bool;
+
+// Returns true if the CPU and the OS support the AVX2 instruction set.
+[[nodiscard]] auto has_avx2() noexcept -> bool;
+
+// Returns true if the CPU and the OS support the AVX-512F instruction set.
+[[nodiscard]] auto has_avx512f() noexcept -> bool;
+
+}  // namespace geohash::cpu
@@ -0,0 +1,79 @@
+#pragma once
+#include <Eigen/Core>
+#include <vector>
+
+#include "geohash/geometry.hpp"
+#include "geohash/int64.hpp"
+
+// Batch containment tests filtering arrays of points, typically the
+// candidates found in the cells covering a geometry.
+namespace geohash::filter {
+
+// Returns the mask of the points within the box using "num_threads" threads.
+[[nodiscard]] auto contains(
+    const Box& box, const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
+    size_t num_threads) -> Eigen::Matrix<bool, -1, 1>;
+
+// Returns the mask of the positions, defined by separate vectors of
+// longitudes and latitudes, within the box using "num_threads" threads.
+template <typename T>
+[[nodiscard]] auto contains(const Box& box, const int64::Coordinates<T>& lng,
+                            const int64::Coordinates<T>& lat,
+                            size_t num_threads) -> Eigen::Matrix<bool, -1, 1>;
+
+// Polygon prepared to test whether many points are inside it. Its edges,
+// straight lines in the longitude/latitude plane, are indexed once by bands
+// of latitude, so that a point is only tested against the edges crossing the
+// band holding it. The inner rings are holes: a point is inside the polygon
+// if a ray cast from it crosses its edges an odd number of times. Like the
+// covers of polygons, std::invalid_argument is thrown if an edge spans more
+// than 180 degrees of longitude, the polygon crossing the antimeridian.
+class PreparedPolygon {
+ public:
+  // Indexes the edges of the polygon.
+  explicit PreparedPolygon(const Polygon& polygon);
+
+  // Returns the envelope of the polygon.
+  [[nodiscard]] inline auto envelope() const -> const Box& {
+    return envelope_;
+  }
+
+  // Returns true if the point is inside the polygon.
+  [[nodiscard]] auto contains(const Point& point) const -> bool;
+
+  // Returns the mask of the points inside the polygon using "num_threads"
+  // threads.
+  [[nodiscard]] auto contains(
+      const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
+      size_t num_threads) const -> Eigen::Matrix<bool, -1, 1>;
+
+  // Returns the mask of the positions, defined by separate vectors of
+  // longitudes and latitudes, inside the polygon using "num_threads"
+  // threads.
+  template <typename T>
+  [[nodiscard]] auto contains(const int64::Coordinates<T>& lng,
+                              const int64::Coordinates<T>& lat,
+                              size_t num_threads) const
+      -> Eigen::Matrix<bool, -1, 1>;
+
+ private:
+  // Edge not parallel to the equator: its latitudes [lat_min, lat_max[ and
+  // the longitude of its crossing with the latitude "lat" is
+  // lng + (lat - lat0) * slope.
+  struct Edge {
+    double lat_min;
+    double lat_max;
+    double lng;
+    double lat0;
+    double slope;
+  };
+
+  Box envelope_{};
+  // Number of bands per degree of latitude.
+  double scale_{};
+  // The edges crossing the band ix are edges_[offsets_[ix]:offsets_[ix+1]].
+  std::vector<size_t> offsets_{};
+  std::vector<Edge> edges_{};
+};
+
+}  // namespace geohash::filter
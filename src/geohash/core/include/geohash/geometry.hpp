@@ -4,6 +4,7 @@
 #include <boost/geometry/geometries/register/point.hpp>
 #include <cmath>
 #include <list>
+#include <stdexcept>
 #include <tuple>
 
 #include "geohash/math.hpp"
@@ -67,18 +68,14 @@ class Box {
   }
 
   // Returns true if the geographic point is within the box
-  [[nodiscard]] auto contains(const Point& point) const -> bool {
-    // box wraps around the globe ?
-    if (min_corner_.lng > max_corner_.lng) {
-      for (const auto& item : split()) {
-        if (!item.contains(point)) {
-          return false;
-        }
-      }
-      return true;
-    }
-    return (min_corner_.lat <= point.lat && point.lat <= max_corner_.lat &&
-            min_corner_.lng <= point.lng && point.lng <= max_corner_.lng);
+  [[nodiscard]] inline auto contains(const Point& point) const -> bool {
+    // box wraps around the globe ? the point is then within one of the boxes
+    // on either side of the dateline.
+    const auto lng =
+        min_corner_.lng > max_corner_.lng
+            ? (min_corner_.lng <= point.lng || point.lng <= max_corner_.lng)
+            : (min_corner_.lng <= point.lng && point.lng <= max_corner_.lng);
+    return lng && min_corner_.lat <= point.lat && point.lat <= max_corner_.lat;
   }
 
   // Returns the minimum corner point
@@ -117,4 +114,25 @@ namespace geohash {
 
 using Polygon = boost::geometry::model::polygon<Point>;
 
+// Checks that no edge of the polygon spans more than 180 degrees of
+// longitude. The covers of polygons join the vertices by straight lines in
+// the longitude/latitude plane: the edge of a ring crossing the antimeridian,
+// from 179 to -179 degrees for instance, would then go around the globe.
+inline auto check_antimeridian(const Polygon& polygon) -> void {
+  auto check_ring = [](const auto& ring) {
+    for (size_t ix = 0; ix < ring.size(); ++ix) {
+      const auto& p = ring[ix];
+      const auto& q = ring[(ix + 1) % ring.size()];
+      if (std::abs(q.lng - p.lng) > 180) {
+        throw std::invalid_argument(
+            "the edges of the polygon must not cross the antimeridian");
+      }
+    }
+  };
+  check_ring(polygon.outer());
+  for (const auto& item : polygon.inners()) {
+    check_ring(item);
+  }
+}
+
 }  // namespace geohash
@@ -1,8 +1,8 @@
 #pragma once
 #include <Eigen/Core>
-#include <map>
 #include <optional>
 #include <tuple>
+#include <vector>
 
 #include "geohash/geometry.hpp"
 #include "geohash/math.hpp"
@@ -22,73 +22,325 @@ namespace geohash::int64 {
 // Encode a point into geohash with the given precision
 [[nodiscard]] auto encode(const Point& point, uint32_t precision) -> uint64_t;
 
-// Encode points into geohash with the given precision
-[[nodiscard]] inline auto encode(
+// Encode points into geohash with the given precision using "num_threads"
+// threads (0 selects the default number of threads).
+[[nodiscard]] auto encode(
     const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
-    uint32_t precision) -> Eigen::Matrix<uint64_t, -1, 1> {
-  auto result = Eigen::Matrix<uint64_t, -1, 1>(points.size());
-  for (Eigen::Index ix = 0; ix < points.size(); ++ix) {
-    result(ix) = encode(points(ix), precision);
-  }
-  return result;
-}
+    uint32_t precision, size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1>;
+
+// Vector of coordinates, contiguous or strided, read in place.
+template <typename T>
+using Coordinates =
+    Eigen::Ref<const Eigen::Matrix<T, -1, 1>, 0, Eigen::InnerStride<>>;
+
+// Vector of coordinates, contiguous or strided, written in place.
+template <typename T>
+using MutableCoordinates =
+    Eigen::Ref<Eigen::Matrix<T, -1, 1>, 0, Eigen::InnerStride<>>;
+
+// Encode the points defined by separate vectors of longitudes and latitudes
+// into geohash with the given precision using "num_threads" threads.
+template <typename T>
+[[nodiscard]] auto encode(const Coordinates<T>& lng, const Coordinates<T>& lat,
+                          uint32_t precision, size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1>;
 
 // Returns the region encoded by the integer geohash with the specified
 // precision.
 [[nodiscard]] auto bounding_box(uint64_t hash, uint32_t precision) -> Box;
 
+// Writes the regions encoded by the integer geohashs with the specified
+// precision into separate vectors of minimum and maximum longitudes and
+// latitudes using "num_threads" threads.
+auto bounding_box(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+                  uint32_t precision, MutableCoordinates<double> lng_min,
+                  MutableCoordinates<double> lat_min,
+                  MutableCoordinates<double> lng_max,
+                  MutableCoordinates<double> lat_max, size_t num_threads)
+    -> void;
+
 // Decode a hash into a spherical equatorial point with the given precision.
 // If round is true, the coordinates of the points will be rounded to the
 // accuracy defined by the GeoHash.
-[[nodiscard]] inline auto decode(const uint64_t hash, const uint32_t precision,
-                                 const bool round) -> Point {
-  auto bbox = bounding_box(hash, precision);
-  return round ? bbox.round() : bbox.center();
-}
+[[nodiscard]] auto decode(uint64_t hash, uint32_t precision, bool round)
+    -> Point;
 
-// Decode hashs into a spherical equatorial points with the given bit depth.
-// If round is true, the coordinates of the points will be rounded to the
-// accuracy defined by the GeoHash.
-[[nodiscard]] inline auto decode(
+// Decode hashs into a spherical equatorial points with the given bit depth
+// using "num_threads" threads. If round is true, the coordinates of the points
+// will be rounded to the accuracy defined by the GeoHash.
+[[nodiscard]] auto decode(
     const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
-    const uint32_t precision, const bool center)
-    -> Eigen::Matrix<Point, -1, 1> {
-  auto result = Eigen::Matrix<Point, -1, 1>(hashs.size());
-  for (Eigen::Index ix = 0; ix < hashs.size(); ++ix) {
-    result(ix) = decode(hashs(ix), precision, center);
-  }
-  return result;
-}
+    uint32_t precision, bool round, size_t num_threads)
+    -> Eigen::Matrix<Point, -1, 1>;
+
+// Decode hashs into separate vectors of longitudes and latitudes with the
+// given bit depth using "num_threads" threads. If round is true, the
+// coordinates of the points will be rounded to the accuracy defined by the
+// GeoHash.
+template <typename T>
+auto decode(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+            uint32_t precision, bool round, MutableCoordinates<T> lng,
+            MutableCoordinates<T> lat, size_t num_threads) -> void;
 
 // Returns all neighbors hash clockwise from north around northwest at the given
-// precision.
+// precision. Longitudes wrap around the antimeridian, latitudes saturate at
+// the poles: the neighbors beyond a pole are taken from the polar row.
 // 7 0 1
 // 6 x 2
 // 5 4 3
 [[nodiscard]] auto neighbors(const uint64_t hash, const uint32_t precision)
     -> Eigen::Matrix<uint64_t, 8, 1>;
 
+// Returns the neighbors of each hash of the vector, one row per hash, using
+// "num_threads" threads.
+[[nodiscard]] auto neighbors(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    uint32_t precision, size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 8, Eigen::RowMajor>;
+
+// Returns the number of cells within the Chebyshev distance k of a cell.
+[[nodiscard]] inline constexpr auto k_ring_size(const uint32_t k) -> size_t {
+  return (2 * static_cast<size_t>(k) + 1) * (2 * static_cast<size_t>(k) + 1);
+}
+
+// Returns all the cells within the Chebyshev distance k of hash: the cell
+// itself followed by the rings of distance 1 to k, each one clockwise from
+// north. The first ring is therefore identical to the result of "neighbors".
+// Cells are repeated near the poles, or if a ring is wider than the globe.
+// Throws std::invalid_argument if k exceeds the number of columns of the
+// grid at the given precision.
+[[nodiscard]] auto k_ring(uint64_t hash, uint32_t precision, uint32_t k)
+    -> Eigen::Matrix<uint64_t, -1, 1>;
+
+// Returns the cells within the Chebyshev distance k of each hash of the
+// vector, one row per hash, using "num_threads" threads.
+[[nodiscard]] auto k_ring(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    uint32_t precision, uint32_t k, size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>;
+
 // Returns the property of the grid covering the given box: geohash of the
 // minimum corner point, number of boxes in longitudes and latitudes.
 [[nodiscard]] auto grid_properties(const Box& box, uint32_t precision)
     -> std::tuple<uint64_t, size_t, size_t>;
 
+// Writes the codes of the cells [col, col + count) of the row "row" of the
+// grid whose south-west cell is hash_sw. The cells are obtained by stepping
+// the bits of the longitude and the latitude of hash_sw, without decoding
+// or re-encoding positions.
+auto grid_walk(uint64_t hash_sw, uint32_t precision, size_t row, size_t col,
+               size_t count, uint64_t* codes) -> void;
+
+// Grid of the cells covering a box. The codes of the cells are generated on
+// demand, in row order, so that a part of the grid can be produced without
+// materializing the whole grid.
+class Grid {
+ public:
+  // Creates the grid covering the box (the whole Earth if the box is not
+  // defined) with the given precision.
+  Grid(const std::optional<Box>& box, uint32_t precision);
+
+  // Returns the precision of the codes.
+  [[nodiscard]] inline auto precision() const noexcept -> uint32_t {
+    return precision_;
+  }
+
+  // Returns the number of cells of the grid.
+  [[nodiscard]] inline auto size() const noexcept -> size_t { return size_; }
+
+  // Writes the codes of the cells [start, start + count) of the grid using
+  // "num_threads" threads.
+  auto codes(size_t start, size_t count, uint64_t* codes,
+             size_t num_threads) const -> void;
+
+ private:
+  // Part of the grid, on one side of the antimeridian.
+  struct Part {
+    // Code of the south-west cell
+    uint64_t hash_sw;
+    // Number of cells in longitude and latitude
+    size_t cols;
+    size_t rows;
+    // Index of the first cell of the part in the grid
+    size_t offset;
+  };
+
+  uint32_t precision_;
+  size_t size_{0};
+  std::vector<Part> parts_{};
+
+  // Writes the codes of the cells [index, index + count) without threads.
+  auto walk(size_t index, size_t count, uint64_t* codes) const -> void;
+};
+
+// Iterates over the codes of a grid by chunks of a fixed size. The position
+// of the next chunk (cursor) can be saved and restored to resume the
+// iteration.
+class Cover {
+ public:
+  // Creates the iterator over the cells covering the box with the given
+  // precision, returned by chunks of "chunk_size" codes.
+  Cover(const std::optional<Box>& box, uint32_t precision, size_t chunk_size);
+
+  // Returns the number of cells covering the box.
+  [[nodiscard]] inline auto size() const noexcept -> size_t {
+    return grid_.size();
+  }
+
+  // Returns the number of codes of a chunk.
+  [[nodiscard]] inline auto chunk_size() const noexcept -> size_t {
+    return chunk_size_;
+  }
+
+  // Returns the index of the first cell of the next chunk.
+  [[nodiscard]] inline auto cursor() const noexcept -> size_t {
+    return cursor_;
+  }
+
+  // Returns the grid of the cells covering the box.
+  [[nodiscard]] inline auto grid() const noexcept -> const Grid& {
+    return grid_;
+  }
+
+  // Moves the cursor to the cell of the given index.
+  auto seek(size_t cursor) -> void;
+
+  // Returns the range of the cells of the next chunk and moves the cursor
+  // after it. The codes of the range can then be written by grid() while
+  // the cursor is moved by another thread.
+  auto advance() -> std::tuple<size_t, size_t>;
+
+  // Returns the codes of the next chunk using "num_threads" threads. The
+  // vector returned is empty if all the cells have been returned.
+  [[nodiscard]] auto next(size_t num_threads)
+      -> Eigen::Matrix<uint64_t, -1, 1>;
+
+ protected:
+  Grid grid_;
+  size_t chunk_size_;
+  size_t cursor_{0};
+};
+
 // Returns all the GeoHash codes within the box.
-[[nodiscard]] auto bounding_boxes(const std::optional<Box>& box, uint32_t chars)
+[[nodiscard]] auto bounding_boxes(const std::optional<Box>& box, uint32_t chars,
+                                  size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1>;
+
+// Returns the codes of the cells within the polygon and the codes of the
+// cells crossing its boundary, sorted, using "num_threads" threads. The edges
+// of the polygon are straight lines in the longitude/latitude plane, like the
+// edges of the cells. The polygons crossing the antimeridian are not handled:
+// std::invalid_argument is thrown if an edge spans more than 180 degrees of
+// longitude, such a polygon having to be split at +/-180 degrees by the
+// caller. The same holds for the other covers of polygons.
+[[nodiscard]] auto polygon_cover(const Polygon& polygon, uint32_t precision,
+                                 size_t num_threads)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>>;
+
+// Returns the sorted GeoHash codes of the cells intersecting the polygon.
+[[nodiscard]] auto bounding_boxes(const Polygon& polygon, uint32_t precision,
+                                  size_t num_threads)
     -> Eigen::Matrix<uint64_t, -1, 1>;
 
-// Returns all the GeoHash codes within the polygon.
-[[nodiscard]] inline auto bounding_boxes(const Polygon& polygon, uint32_t chars)
-    -> Eigen::Matrix<uint64_t, -1, 1> {
-  auto box = Box();
-  boost::geometry::envelope<Polygon, Box>(polygon, box);
-  return bounding_boxes(box, chars);
+// Cells of a circle cover: their codes and the minimum and maximum
+// great-circle distances, in meters, between the center of the circle and
+// the points of each cell.
+using CircleCover =
+    std::tuple<Eigen::Matrix<uint64_t, -1, 1>, Eigen::Matrix<double, -1, 1>,
+               Eigen::Matrix<double, -1, 1>>;
+
+// Returns the cells of the given precision within "radius" meters of the
+// point, sorted by increasing minimum distance, using "num_threads" threads.
+// The distances are computed with the haversine formula on a sphere of the
+// mean Earth radius.
+[[nodiscard]] auto circle_cover(const Point& center, double radius,
+                                uint32_t precision, size_t num_threads)
+    -> CircleCover;
+
+// Replaces recursively the complete groups of 32 sibling cells by their
+// parent, five bits coarser, and returns the codes and the precisions of the
+// resulting mixed-precision cover sorted along the Z-order curve. Cells
+// contained in another cell of the input are removed.
+[[nodiscard]] auto compact(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint32_t, -1, 1>>;
+
+// Compacts codes sharing the same precision.
+[[nodiscard]] inline auto compact(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    const uint32_t precision)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint32_t, -1, 1>> {
+  return compact(hashs, Eigen::Matrix<uint32_t, -1, 1>::Constant(
+                            hashs.size(), precision));
 }
 
-// Returns the start and end indexes of the different GeoHash boxes.
+// Returns the codes at the given precision of all the cells covered by a
+// mixed-precision cover using "num_threads" threads. The precision of each
+// code must not be greater than the requested precision.
+[[nodiscard]] auto expand(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions,
+    uint32_t precision, size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1>;
+
+// Returns the sorted and disjoint intervals [start, end) of the codes of the
+// given precision covering the box (the whole Earth if the box is not
+// defined), one interval per row. If "max_ranges" is not zero, the closest
+// intervals are merged until at most "max_ranges" remain: the intervals then
+// also cover codes outside the box. The end of an interval reaching the last
+// code of the precision 64 is 0.
+[[nodiscard]] auto range_cover(const std::optional<Box>& box,
+                               uint32_t precision, size_t max_ranges)
+    -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor>;
+
+// Returns the intervals [start, end) of the codes of the cells intersecting
+// the polygon computed using "num_threads" threads.
+[[nodiscard]] auto range_cover(const Polygon& polygon, uint32_t precision,
+                               size_t max_ranges, size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor>;
+
+// Distinct codes of a grid, sorted, and the extents of the pixels holding
+// each of them: first and last rows, first and last columns.
+using Extents =
+    std::tuple<Eigen::Matrix<uint64_t, -1, 1>, Eigen::Matrix<int64_t, -1, 1>,
+               Eigen::Matrix<int64_t, -1, 1>, Eigen::Matrix<int64_t, -1, 1>,
+               Eigen::Matrix<int64_t, -1, 1>>;
+
+// Returns the extents of the different GeoHash boxes of a grid using
+// "num_threads" threads. The bands of rows processed by each thread are
+// indexed in one pass, then the partial results are merged.
 [[nodiscard]] auto where(
-    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, -1>>& hashs)
-    -> std::map<uint64_t, std::tuple<std::tuple<int64_t, int64_t>,
-                                     std::tuple<int64_t, int64_t>>>;
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>>&
+        hashs,
+    size_t num_threads) -> Extents;
+
+// Sorts the codes of the given precision along the Z-order curve with a
+// parallel LSD radix sort, using "num_threads" threads. Returns the
+// permutation sorting the codes and the sorted codes. The sort is stable.
+[[nodiscard]] auto argsort(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    uint32_t precision, size_t num_threads)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>>;
+
+// Encodes the points defined by separate vectors of longitudes and latitudes
+// and sorts them along the Z-order curve. The codes are encoded by the
+// threads that sort them, in the same pass as the first histogram of the
+// radix sort.
+template <typename T>
+[[nodiscard]] auto argsort(const Coordinates<T>& lng, const Coordinates<T>& lat,
+                           uint32_t precision, size_t num_threads)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>>;
+
+// Reorders in place "size" items of "item_size" bytes, separated by "stride"
+// bytes, so that the item ix becomes the item permutation(ix), using
+// "num_threads" threads.
+auto permute(char* data, size_t size, size_t item_size, int64_t stride,
+             const Eigen::Ref<const Eigen::Matrix<int64_t, -1, 1>>& permutation,
+             size_t num_threads) -> void;
 
 }  // namespace geohash::int64
@@ -0,0 +1,177 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "geohash/geometry.hpp"
+
+// Low-level functions encoding the positions into interleaved bits and
+// extracting them. Several implementations (kernels) are compiled: the fastest
+// one supported by the CPU is measured and selected when the library is
+// loaded, unless the environment variable GEOHASH_KERNEL names the kernel to
+// use. All kernels return identical results.
+namespace geohash::kernel {
+
+// Spread out the 32 bits of x into 64 bits, where the bits of x occupy even
+// bit positions.
+inline constexpr auto spread(const uint32_t x) -> uint64_t {
+  auto result = static_cast<uint64_t>(x);
+  result = (result | (result << 16U)) & 0X0000FFFF0000FFFFUL;
+  result = (result | (result << 8U)) & 0X00FF00FF00FF00FFUL;
+  result = (result | (result << 4U)) & 0X0F0F0F0F0F0F0F0FUL;
+  result = (result | (result << 2U)) & 0X3333333333333333UL;
+  result = (result | (result << 1U)) & 0X5555555555555555UL;
+  return result;
+}
+
+// Squash the even bitlevels of X into a 32-bit word. Odd bitlevels of X are
+// ignored, and may take any value.
+inline constexpr auto squash(uint64_t x) -> uint32_t {
+  x &= 0x5555555555555555UL;
+  x = (x | (x >> 1U)) & 0X3333333333333333UL;
+  x = (x | (x >> 2U)) & 0X0F0F0F0F0F0F0F0FUL;
+  x = (x | (x >> 4U)) & 0X00FF00FF00FF00FFUL;
+  x = (x | (x >> 8U)) & 0X0000FFFF0000FFFFUL;
+  x = (x | (x >> 16U)) & 0X00000000FFFFFFFFUL;
+  return static_cast<uint32_t>(x);
+}
+
+// Encode the position of x within the range -r to +r as a 32-bit integer,
+// scale being 1 / 2r. 1.5 + x * scale lies in [1, 2[, so the 32 most
+// significant bits of its mantissa are the position of x.
+inline auto quantize(const double x, const double r, const double scale)
+    -> uint32_t {
+  if (x == r) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  auto value = 1.5 + (x * scale);
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return static_cast<uint32_t>(bits >> 20U);
+}
+
+// Decode the 32-bit range encoding X back to a value in the range -r to +r.
+inline constexpr auto decode_range(const uint32_t x, const double r)
+    -> double {
+  if (x == std::numeric_limits<uint32_t>::max()) {
+    return r;
+  }
+  auto p = static_cast<double>(x) * (1.0 / 4294967296.0);  // 1 / 2^32
+  return 2 * r * p - r;
+}
+
+// Constants used to decode the hashs of a given precision. They reproduce the
+// arithmetic of Box::center and Box::round without evaluating a logarithm for
+// each hash.
+struct Decoder {
+  // Number of bits to shift a hash to the left to obtain a hash of 64 bits
+  uint32_t shift;
+  // Size of a cell in longitude and latitude
+  double lng_err;
+  double lat_err;
+  // Power of ten used to round the coordinates of a cell
+  double lng_round;
+  double lat_round;
+
+  // Returns the point of the cell whose minimum corner is decoded from the
+  // bits of the latitude and the longitude.
+  [[nodiscard]] inline auto decode(const uint32_t lat_bits,
+                                   const uint32_t lng_bits,
+                                   const bool round) const -> Point {
+    auto lng = decode_range(lng_bits, 180);
+    auto lat = decode_range(lat_bits, 90);
+    if (round) {
+      return {std::ceil(lng / lng_round) * lng_round,
+              std::ceil(lat / lat_round) * lat_round};
+    }
+    return {(lng + (lng + lng_err)) * 0.5, (lat + (lat + lat_err)) * 0.5};
+  }
+};
+
+// Returns the decoding constants of the given precision (in [1, 64]).
+[[nodiscard]] auto decoder(uint32_t precision) -> const Decoder&;
+
+// Set of functions implemented by a kernel.
+struct Kernel {
+  // Name of the kernel
+  const char* name;
+
+  // Encode the position into a hash of 64 bits
+  uint64_t (*encode)(double lat, double lng);
+
+  // Deinterleave the bits of a hash into the bits of the latitude and the
+  // longitude.
+  std::tuple<uint32_t, uint32_t> (*deinterleave)(uint64_t hash);
+
+  // Encode points into geohash with the given precision
+  void (*encode_points)(const Point* points, size_t size, uint32_t precision,
+                        uint64_t* hashs);
+
+  // Encode the positions given as contiguous arrays of longitudes and
+  // latitudes into geohash with the given precision
+  void (*encode_lnglat_f64)(const double* lng, const double* lat, size_t size,
+                            uint32_t precision, uint64_t* hashs);
+  void (*encode_lnglat_f32)(const float* lng, const float* lat, size_t size,
+                            uint32_t precision, uint64_t* hashs);
+
+  // Decode hashs into points. If round is true, the coordinates of the points
+  // are rounded to the accuracy defined by the GeoHash.
+  void (*decode_points)(const uint64_t* hashs, size_t size,
+                        const Decoder& decoder, bool round, Point* points);
+
+  // Decode the regions encoded by the hashs into contiguous arrays of
+  // minimum and maximum longitudes and latitudes.
+  void (*decode_boxes)(const uint64_t* hashs, size_t size,
+                       const Decoder& decoder, double* lng_min,
+                       double* lat_min, double* lng_max, double* lat_max);
+
+  // Encode hashs of "chars" characters into base32 strings written "stride"
+  // bytes apart. Only the characters of the hashs are written.
+  void (*encode_base32)(const uint64_t* hashs, size_t size, uint32_t chars,
+                        size_t stride, char* buffer);
+
+  // Decode base32 strings of at most "stride" characters, null padded, into
+  // hashs and numbers of characters. Returns the index of the first string
+  // holding an invalid character, or size if all strings are valid.
+  size_t (*decode_base32)(const char* buffer, size_t size, size_t stride,
+                          uint64_t* hashs, uint32_t* chars);
+
+  // Tests whether the points are within the box, which may wrap around the
+  // antimeridian (see Box::contains).
+  void (*box_contains_points)(const Point* points, size_t size,
+                              const Box& box, bool* mask);
+
+  // Tests whether the positions given as contiguous arrays of longitudes and
+  // latitudes are within the box.
+  void (*box_contains_lnglat)(const double* lng, const double* lat,
+                              size_t size, const Box& box, bool* mask);
+};
+
+// Returns the kernels supported by the CPU.
+[[nodiscard]] auto available() -> std::vector<const Kernel*>;
+
+// Returns the kernel in use.
+[[nodiscard]] auto current() noexcept -> const Kernel&;
+
+// Selects the kernel to use. Throws std::invalid_argument if the kernel is
+// unknown or not supported by the CPU.
+auto select(const std::string& name) -> void;
+
+// Encode the positions given as contiguous arrays of longitudes and latitudes
+// with the kernel in use.
+inline auto encode(const double* lng, const double* lat, const size_t size,
+                   const uint32_t precision, uint64_t* hashs) -> void {
+  current().encode_lnglat_f64(lng, lat, size, precision, hashs);
+}
+
+inline auto encode(const float* lng, const float* lat, const size_t size,
+                   const uint32_t precision, uint64_t* hashs) -> void {
+  current().encode_lnglat_f32(lng, lat, size, precision, hashs);
+}
+
+}  // namespace geohash::kernel
@@ -0,0 +1,77 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace geohash::parallel {
+
+// Minimum number of items processed by a thread. Below this size, the cost of
+// starting a thread is greater than the time saved.
+static constexpr size_t kMinChunkSize = 16384;
+
+// Returns the number of threads used by default by the parallel algorithms.
+[[nodiscard]] auto get_num_threads() noexcept -> size_t;
+
+// Sets the number of threads used by default by the parallel algorithms. If
+// num_threads is 0, the number of concurrent threads supported by the CPU is
+// used.
+auto set_num_threads(size_t num_threads) noexcept -> void;
+
+// Returns the number of threads to use to process "size" items with at least
+// "min_chunk_size" items per thread. If num_threads is 0, the default number
+// of threads is used.
+[[nodiscard]] inline auto num_workers(const size_t size,
+                                      const size_t num_threads,
+                                      const size_t min_chunk_size =
+                                          kMinChunkSize) noexcept -> size_t {
+  auto result = num_threads == 0 ? get_num_threads() : num_threads;
+  return std::max(std::min(result, size / std::max(min_chunk_size, size_t(1))),
+                  size_t(1));
+}
+
+// Splits the range [0, size) into contiguous chunks processed in parallel by
+// "worker(start, end)". Each item is processed by exactly one call, so the
+// result does not depend on the number of threads used. The first exception
+// raised by a worker is rethrown once all threads are finished.
+template <typename Worker>
+auto dispatch(const Worker& worker, const size_t size, const size_t num_threads,
+              const size_t min_chunk_size = kMinChunkSize) -> void {
+  const auto workers = num_workers(size, num_threads, min_chunk_size);
+  if (workers == 1) {
+    worker(size_t(0), size);
+    return;
+  }
+
+  const auto chunk = (size + workers - 1) / workers;
+  auto exceptions = std::vector<std::exception_ptr>(workers);
+  auto threads = std::vector<std::thread>();
+  threads.reserve(workers - 1);
+
+  auto run = [&](const size_t index) {
+    try {
+      const auto start = index * chunk;
+      worker(start, std::min(start + chunk, size));
+    } catch (...) {
+      exceptions[index] = std::current_exception();
+    }
+  };
+
+  for (size_t ix = 1; ix < workers; ++ix) {
+    threads.emplace_back(run, ix);
+  }
+  // The calling thread processes the first chunk.
+  run(0);
+
+  for (auto& item : threads) {
+    item.join();
+  }
+  for (auto& item : exceptions) {
+    if (item != nullptr) {
+      std::rethrow_exception(item);
+    }
+  }
+}
+
+}  // namespace geohash::parallel
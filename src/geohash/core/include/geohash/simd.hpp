@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+#include "geohash/geometry.hpp"
+#include "geohash/kernel.hpp"
+
+// Batch kernels processing several points per iteration with the vector
+// instructions available on the CPU. Each kernel processes as many points as
+// its vector width allows and returns the number of items handled: the caller
+// completes the remaining items with the scalar functions.
+namespace geohash::simd {
+
+// Encode points into geohash with the given precision, 4 points at a time.
+auto encode_avx2(const Point* points, size_t size, uint32_t precision,
+                 uint64_t* hashs) -> size_t;
+
+// Encode points into geohash with the given precision, 8 points at a time.
+auto encode_avx512(const Point* points, size_t size, uint32_t precision,
+                   uint64_t* hashs) -> size_t;
+
+// Encode the coordinates given as separate arrays into geohash with the
+// given precision, 4 points at a time.
+auto encode_avx2(const double* lng, const double* lat, size_t size,
+                 uint32_t precision, uint64_t* hashs) -> size_t;
+auto encode_avx2(const float* lng, const float* lat, size_t size,
+                 uint32_t precision, uint64_t* hashs) -> size_t;
+
+// Encode the coordinates given as separate arrays into geohash with the
+// given precision, 8 points at a time.
+auto encode_avx512(const double* lng, const double* lat, size_t size,
+                   uint32_t precision, uint64_t* hashs) -> size_t;
+auto encode_avx512(const float* lng, const float* lat, size_t size,
+                   uint32_t precision, uint64_t* hashs) -> size_t;
+
+// Decode hashs into points, 4 hashs at a time.
+auto decode_avx2(const uint64_t* hashs, size_t size,
+                 const kernel::Decoder& decoder, bool round, Point* points)
+    -> size_t;
+
+// Decode hashs into points, 8 hashs at a time.
+auto decode_avx512(const uint64_t* hashs, size_t size,
+                   const kernel::Decoder& decoder, bool round, Point* points)
+    -> size_t;
+
+// Decode the regions encoded by the hashs into separate arrays of minimum and
+// maximum coordinates, 4 hashs at a time.
+auto decode_boxes_avx2(const uint64_t* hashs, size_t size,
+                       const kernel::Decoder& decoder, double* lng_min,
+                       double* lat_min, double* lng_max, double* lat_max)
+    -> size_t;
+
+// Decode the regions encoded by the hashs into separate arrays of minimum and
+// maximum coordinates, 8 hashs at a time.
+auto decode_boxes_avx512(const uint64_t* hashs, size_t size,
+                         const kernel::Decoder& decoder, double* lng_min,
+                         double* lat_min, double* lng_max, double* lat_max)
+    -> size_t;
+
+// Encode hashs of "chars" characters into base32, "stride" bytes apart, one
+// hash at a time: the 5-bit indexes are spread into bytes and converted to
+// characters by byte shuffles.
+auto encode_base32_avx2(const uint64_t* hashs, size_t size, uint32_t chars,
+                        size_t stride, char* buffer) -> size_t;
+
+// Decode the base32 hashs of at most "stride" characters, null padded, into
+// hashs and numbers of characters, all the characters of a hash being
+// validated at once by vector comparisons. Returns the number of hashs
+// decoded before the first invalid one.
+auto decode_base32_avx2(const char* buffer, size_t size, size_t stride,
+                        uint64_t* hashs, uint32_t* chars) -> size_t;
+
+// Test whether the points are within the box, four points at a time.
+auto box_contains_avx2(const Point* points, size_t size, const Box& box,
+                       bool* mask) -> size_t;
+
+// Test whether the positions given as separate arrays are within the box,
+// four positions at a time.
+auto box_contains_avx2(const double* lng, const double* lat, size_t size,
+                       const Box& box, bool* mask) -> size_t;
+
+}  // namespace geohash::simd
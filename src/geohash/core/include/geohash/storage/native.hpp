@@ -0,0 +1,80 @@
+#pragma once
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Serialization of lists of numpy arrays, or of tuples of numpy arrays,
+// without pickle. The serialized values start with a header describing the
+// items and the dtype, shape and strides of the arrays, followed by the raw
+// data of the arrays, aligned on kAlignment bytes.
+namespace geohash::storage::native {
+
+// Alignment of the data of the arrays in the serialized values.
+static constexpr size_t kAlignment = 16;
+
+// List of values prepared to be serialized without the GIL.
+class Encoder {
+ public:
+  // Prepares the serialization of the values. Returns std::nullopt if an item
+  // is neither a numpy array of fixed size elements, with at most 32
+  // dimensions, nor a tuple of such arrays. Requires the GIL.
+  [[nodiscard]] static auto prepare(const pybind11::list& values)
+      -> std::optional<Encoder>;
+
+  // Returns the size of the serialized values.
+  [[nodiscard]] inline auto size() const noexcept -> size_t { return size_; }
+
+  // Serializes the values into "buffer", which holds size() bytes. Does not
+  // require the GIL.
+  auto write(char* buffer) const -> void;
+
+ private:
+  // Data of an array and its position in the serialized values.
+  struct Block {
+    const char* ptr;
+    size_t size;
+    size_t offset;
+  };
+
+  std::string header_{};
+  std::vector<Block> blocks_{};
+  // Keeps alive the arrays referenced by the blocks.
+  std::vector<pybind11::array> arrays_{};
+  size_t size_{};
+};
+
+// Serialized values, parsed without the GIL.
+class Decoder {
+ public:
+  // Default constructor
+  Decoder() = default;
+
+  // Parses the "size" bytes of serialized values. Does not require the GIL.
+  Decoder(const char* buffer, size_t size);
+
+  // Returns the list of values. The arrays are views on "buffer", holding the
+  // serialized values parsed, kept alive by "owner". Requires the GIL.
+  [[nodiscard]] auto values(char* buffer, const pybind11::handle& owner) const
+      -> pybind11::list;
+
+ private:
+  // Description of an array
+  struct Array {
+    std::string dtype;
+    std::vector<pybind11::ssize_t> shape;
+    std::vector<pybind11::ssize_t> strides;
+    size_t offset;
+    size_t size;
+  };
+
+  // Number of arrays of each item, or -1 if the item is an array and not a
+  // tuple.
+  std::vector<int64_t> items_{};
+  std::vector<Array> arrays_{};
+};
+
+}  // namespace geohash::storage::native
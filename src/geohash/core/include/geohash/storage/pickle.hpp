@@ -19,8 +19,9 @@ class Pickle {
   }
 
   // Return the reconstituted object hierarchy of the pickled representation
-  // bytes_object of an object.
-  [[nodiscard]] inline auto loads(const pybind11::bytes& bytes_object) const
+  // bytes_object of an object. bytes_object can be any bytes-like object,
+  // such as a memoryview.
+  [[nodiscard]] inline auto loads(const pybind11::object& bytes_object) const
       -> pybind11::object {
     return loads_(bytes_object);
   }
@@ -1,7 +1,11 @@
 #pragma once
 #include <pybind11/pybind11.h>
 #include <unqlite.h>
+#include <zstd.h>
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 
@@ -31,10 +35,22 @@ class LockError : public std::runtime_error {
 };
 
 // The data stored in the database can be compressed using the following
-// algorithms.
+// algorithms. The algorithm used is stored with the data, so a database can
+// hold data compressed by different algorithms.
 enum CompressionType {
   kNoCompression = 0x0,
   kSnappyCompression = 0x1,
+  kLZ4Compression = 0x2,
+  kZstdCompression = 0x3,
+};
+
+// The values stored in the database are serialized using pickle, or using a
+// native codec handling the numpy arrays, and tuples of numpy arrays, without
+// the Python API. Pickle is used for the values not handled by the native
+// codec.
+enum SerializationType {
+  kPickleSerialization = 0x0,
+  kNativeSerialization = 0x1,
 };
 
 // Key/Value store
@@ -42,7 +58,8 @@ class Database {
  public:
   // Default constructor
   Database(std::string name, const std::optional<std::string>& open_mode,
-           CompressionType compression_type);
+           CompressionType compression_type,
+           SerializationType serialization_type, int compression_level);
 
   // Destructor
   virtual ~Database();
@@ -65,20 +82,30 @@ class Database {
       -> void;
 
   // Update the database with the key/value pairs from map, overwriting existing
-  // keys
-  auto update(const pybind11::dict& map) const -> void;
+  // keys. The values are serialized, compressed using "num_threads" threads
+  // and written in transactions of "batch_size" items.
+  auto update(const pybind11::dict& map, size_t batch_size,
+              size_t num_threads) const -> void;
 
-  // Extend or create the database with the key/value pairs from map
+  // Extend or create the database with the key/value pairs from map. The new
+  // values are appended to the records without reading them.
   auto extend(const pybind11::dict& map) const -> void;
 
+  // Rewrite the records of the keys provided, made of several frames by
+  // "extend", in a single frame. The values are written in transactions of
+  // "batch_size" items using "num_threads" threads.
+  auto consolidate(const std::optional<pybind11::list>& keys,
+                   size_t batch_size, size_t num_threads) const -> void;
+
   // Return the item of the database with key key. Return an empty list if key
   // is not in the database.
   [[nodiscard]] auto getitem(const pybind11::bytes& key) const
       -> pybind11::list;
 
-  // Read all values from the database for the keys provided
-  [[nodiscard]] auto values(const std::optional<pybind11::list>& keys) const
-      -> pybind11::list;
+  // Read all values from the database for the keys provided. The values are
+  // uncompressed using "num_threads" threads.
+  [[nodiscard]] auto values(const std::optional<pybind11::list>& keys,
+                            size_t num_threads) const -> pybind11::list;
 
   // Remove the key from the database. Raises a KeyError if key is not int the
   // database
@@ -105,17 +132,49 @@ class Database {
   // Read error log
   [[nodiscard]] auto error_log() const -> std::string;
 
+  // Train a Zstandard dictionary of "capacity" bytes at most from the values
+  // of the keys provided, and store it in the database. The dictionary is
+  // used to compress the values written afterwards with Zstandard.
+  auto train_dictionary(const std::optional<pybind11::list>& keys,
+                        size_t capacity) -> void;
+
  private:
   ::unqlite* handle_{nullptr};
   std::string name_;
   std::string open_mode_;
   Pickle pickle_{};
   CompressionType compression_type_;
+  SerializationType serialization_type_;
+  int compression_level_;
+  // Zstandard dictionary compressing the values, if one has been trained.
+  std::shared_ptr<ZSTD_CDict> dictionary_{};
+  // Zstandard dictionaries loaded to uncompress the values, by ID.
+  mutable std::map<unsigned int, std::shared_ptr<ZSTD_DDict>> dictionaries_{};
+  // Guards dictionary_ and dictionaries_.
+  mutable std::mutex mutex_{};
 
   static auto handle_rc(int rc) -> void;
 
-  auto compress(const pybind11::bytes& bytes) const -> pybind11::bytes;
-  auto uncompress(const pybind11::bytes& bytes) const -> pybind11::bytes;
+  // Appends the record stored for the key to the buffer. Returns false if the
+  // key is not in the database. Does not require the GIL.
+  auto fetch(const char* key, int key_len, std::string& buffer) const -> bool;
+
+  // Returns the Zstandard dictionary "id", read from the database the first
+  // time. Returns nullptr if id is 0. Does not require the GIL.
+  auto dictionary(unsigned int id) const -> const ZSTD_DDict*;
+
+  // Returns the dictionary compressing the values, or nullptr. The reference
+  // returned keeps the dictionary alive if another thread replaces it.
+  [[nodiscard]] auto compression_dictionary() const
+      -> std::shared_ptr<ZSTD_CDict>;
+
+  // Creates the dictionary compressing the values from its content.
+  auto set_dictionary(const std::string& content) -> void;
+
+  // Appends the frame to the record stored for the key. Does not require the
+  // GIL.
+  auto append(const char* key, int key_len, const std::string& frame) const
+      -> void;
 };
 
 }  // namespace geohash::storage::unqlite
\ No newline at end of file
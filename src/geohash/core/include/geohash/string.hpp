@@ -2,12 +2,12 @@
 #include <pybind11/numpy.h>
 
 #include <Eigen/Core>
-#include <map>
 #include <optional>
 #include <tuple>
 #include <vector>
 
 #include "geohash/geometry.hpp"
+#include "geohash/int64.hpp"
 
 namespace geohash::string {
 
@@ -36,6 +36,15 @@ class Array {
                            capsule_);
   }
 
+  // Creates the numpy array of "cols" strings per row from the memory
+  // allocated in the C++ code without copying the data.
+  [[nodiscard]] inline auto pyarray(const size_t cols) -> pybind11::array {
+    return pybind11::array(pybind11::dtype("S" + std::to_string(chars_)),
+                           {size_ / cols, cols},
+                           {cols * chars_ * sizeof(char), chars_ * sizeof(char)},
+                           array_->data(), capsule_);
+  }
+
   static auto get_info(const pybind11::array& hashs, const ssize_t ndim)
       -> pybind11::buffer_info;
 
@@ -49,25 +58,66 @@ class Array {
 // Encode a point into geohash with the given bit depth
 auto encode(const Point& point, char* const buffer, uint32_t precision) -> void;
 
-// Encode points into geohash with the given bit depth
+// Encode points into geohash with the given bit depth using "num_threads"
+// threads (0 selects the default number of threads).
 [[nodiscard]] auto encode(
     const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
-    uint32_t precision) -> pybind11::array;
+    uint32_t precision, size_t num_threads) -> pybind11::array;
+
+// Encode the points defined by separate vectors of longitudes and latitudes
+// into geohash with the given bit depth using "num_threads" threads.
+template <typename T>
+[[nodiscard]] auto encode(const int64::Coordinates<T>& lng,
+                          const int64::Coordinates<T>& lat,
+                          uint32_t precision, size_t num_threads)
+    -> pybind11::array;
 
 // Returns the region encoded
 [[nodiscard]] auto bounding_box(const char* const hash, size_t count) -> Box;
 
+// Writes the regions encoded by the hashs into separate vectors of minimum
+// and maximum longitudes and latitudes using "num_threads" threads.
+auto bounding_box(const pybind11::array& hashs,
+                  int64::MutableCoordinates<double> lng_min,
+                  int64::MutableCoordinates<double> lat_min,
+                  int64::MutableCoordinates<double> lng_max,
+                  int64::MutableCoordinates<double> lat_max,
+                  size_t num_threads) -> void;
+
 // Decode a hash into a spherical equatorial point. If round is true, the
 // coordinates of the points will be rounded to the accuracy defined by the
 // GeoHash.
 [[nodiscard]] auto decode(const char* const hash, const size_t count,
                           const bool round) -> Point;
 
-// Decode hashs into a spherical equatorial points. If round is true, the
-// coordinates of the points will be rounded to the accuracy defined by the
-// GeoHash.
-[[nodiscard]] auto decode(const pybind11::array& hashs, const bool center)
-    -> Eigen::Matrix<Point, -1, 1>;
+// Decode hashs into a spherical equatorial points using "num_threads"
+// threads. If round is true, the coordinates of the points will be rounded to
+// the accuracy defined by the GeoHash.
+[[nodiscard]] auto decode(const pybind11::array& hashs, bool round,
+                          size_t num_threads) -> Eigen::Matrix<Point, -1, 1>;
+
+// Decode hashs into separate vectors of longitudes and latitudes using
+// "num_threads" threads. If round is true, the coordinates of the points will
+// be rounded to the accuracy defined by the GeoHash.
+template <typename T>
+auto decode(const pybind11::array& hashs, bool round,
+            int64::MutableCoordinates<T> lng, int64::MutableCoordinates<T> lat,
+            size_t num_threads) -> void;
+
+// Converts the integer codes of "bits" bits into GeoHash of "chars" characters
+// using "num_threads" threads. If the codes hold more bits than the GeoHash,
+// the GeoHash of their parent cells are returned.
+[[nodiscard]] auto from_int64(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+    uint32_t bits, uint32_t chars, size_t num_threads) -> pybind11::array;
+
+// Converts the GeoHash into integer codes of "bits" bits using "num_threads"
+// threads. If the GeoHash hold more bits than requested, the codes of their
+// parent cells are returned. If "bits" is not set, the codes have 5 bits per
+// character of the array.
+[[nodiscard]] auto to_int64(const pybind11::array& hashs,
+                            const std::optional<uint32_t>& bits,
+                            size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1>;
 
 // Returns all neighbors hash clockwise from north around northwest at the
 // given precision:
@@ -77,21 +127,76 @@ auto encode(const Point& point, char* const buffer, uint32_t precision) -> void;
 [[nodiscard]] auto neighbors(const char* const hash, const size_t count)
     -> pybind11::array;
 
+// Returns the neighbors of each hash of the array, one row per hash, using
+// "num_threads" threads. If unique is true, the sorted union of the neighbors
+// is returned instead.
+[[nodiscard]] auto neighbors(const pybind11::array& hashs, bool unique,
+                             size_t num_threads) -> pybind11::array;
+
+// Returns all the GeoHash within the Chebyshev distance k of hash: the hash
+// itself followed by the rings of distance 1 to k, each one clockwise from
+// north.
+[[nodiscard]] auto k_ring(const char* const hash, size_t count, uint32_t k)
+    -> pybind11::array;
+
+// Iterates over the GeoHash of the grid covering a box by chunks of a fixed
+// size.
+class Cover : public int64::Cover {
+ public:
+  // Creates the iterator over the GeoHash of "chars" characters covering the
+  // box, returned by chunks of "chunk_size" codes.
+  Cover(const std::optional<Box>& box, const uint32_t chars,
+        const size_t chunk_size)
+      : int64::Cover(box, chars * 5, chunk_size), chars_(chars) {}
+
+  // Returns the GeoHash of the next chunk using "num_threads" threads. The
+  // array returned is empty if all the cells have been returned.
+  [[nodiscard]] auto next(size_t num_threads) -> pybind11::array;
+
+ private:
+  uint32_t chars_;
+};
+
 // Returns all GeoHash with the defined box
 [[nodiscard]] auto bounding_boxes(const std::optional<Box>& box,
-                                  const uint32_t chars) -> pybind11::array;
-
-// Returns all the GeoHash codes within the polygon.
-[[nodiscard]] inline auto bounding_boxes(const Polygon& polygon, uint32_t chars)
-    -> pybind11::array {
-  auto box = Box();
-  boost::geometry::envelope<Polygon, Box>(polygon, box);
-  return bounding_boxes(box, chars);
-}
-
-// Returns the start and end indexes of the different GeoHash boxes.
-[[nodiscard]] auto where(const pybind11::array& hashs)
-    -> std::map<std::string, std::tuple<std::tuple<int64_t, int64_t>,
-                                        std::tuple<int64_t, int64_t>>>;
+                                  uint32_t chars, size_t num_threads)
+    -> pybind11::array;
+
+// Returns the GeoHash of the cells within the polygon and the GeoHash of the
+// cells crossing its boundary, sorted, using "num_threads" threads.
+[[nodiscard]] auto polygon_cover(const Polygon& polygon, uint32_t chars,
+                                 size_t num_threads)
+    -> std::tuple<pybind11::array, pybind11::array>;
+
+// Returns the sorted GeoHash of the cells intersecting the polygon.
+[[nodiscard]] auto bounding_boxes(const Polygon& polygon, uint32_t chars,
+                                  size_t num_threads) -> pybind11::array;
+
+// Returns the GeoHash of "chars" characters within "radius" meters of the
+// point, sorted by increasing distance, and the minimum and maximum
+// distances, in meters, between the point and each cell.
+[[nodiscard]] auto circle_cover(const Point& center, double radius,
+                                uint32_t chars, size_t num_threads)
+    -> std::tuple<pybind11::array, Eigen::Matrix<double, -1, 1>,
+                  Eigen::Matrix<double, -1, 1>>;
+
+// Replaces recursively the complete groups of 32 GeoHash sharing the same
+// prefix by this prefix and returns the resulting mixed-length cover sorted
+// along the Z-order curve.
+[[nodiscard]] auto compact(const pybind11::array& hashs) -> pybind11::array;
+
+// Returns all the GeoHash of "chars" characters covered by a mixed-length
+// cover using "num_threads" threads.
+[[nodiscard]] auto expand(const pybind11::array& hashs, uint32_t chars,
+                          size_t num_threads) -> pybind11::array;
+
+// Returns the distinct GeoHash of a grid, sorted, and the extents of the
+// pixels holding each of them: first and last rows, first and last columns.
+// The GeoHash are decoded once into integer keys indexed by int64::where
+// using "num_threads" threads.
+[[nodiscard]] auto where(const pybind11::array& hashs, size_t num_threads)
+    -> std::tuple<pybind11::array, Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<int64_t, -1, 1>, Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<int64_t, -1, 1>>;
 
 }  // namespace geohash::string
@@ -1,14 +1,99 @@
-from typing import Optional, Tuple, overload
+from typing import Iterator, Optional, Tuple, overload
 import numpy
-from . import Point, Box
+from . import Point, Box, Polygon
 
 
+@overload
 def bounding_box(hash: int, precision: int = 64) -> Box:
     ...
 
 
+@overload
+def bounding_box(
+    hashs: numpy.ndarray[numpy.uint64],
+    precision: int = 64,
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+def bounding_box(hashs: numpy.ndarray[numpy.uint64],
+                 lng_min: numpy.ndarray,
+                 lat_min: numpy.ndarray,
+                 lng_max: numpy.ndarray,
+                 lat_max: numpy.ndarray,
+                 precision: int = 64,
+                 num_threads: int = 0) -> None:
+    ...
+
+
+@overload
 def bounding_boxes(box: Optional[Box] = None,
-                   precision: int = 5) -> numpy.ndarray:
+                   precision: int = 5,
+                   num_threads: int = 0) -> numpy.ndarray:
+    ...
+
+
+@overload
+def bounding_boxes(polygon: Polygon,
+                   precision: int = 5,
+                   num_threads: int = 0) -> numpy.ndarray:
+    ...
+
+
+def polygon_cover(polygon: Polygon,
+                  precision: int = 5,
+                  num_threads: int = 0) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    """The edges of the polygon are straight lines in the longitude/latitude
+    plane. The polygons crossing the antimeridian must be split at +/-180
+    degrees: ValueError is raised if an edge spans more than 180 degrees of
+    longitude. The same holds for bounding_boxes and range_cover."""
+    ...
+
+
+def circle_cover(
+        center: Point,
+        radius: float,
+        precision: int = 5,
+        num_threads: int = 0
+) -> Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+@overload
+def range_cover(box: Optional[Box] = None,
+                precision: int = 5,
+                max_ranges: int = 0) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+@overload
+def range_cover(polygon: Polygon,
+                precision: int = 5,
+                max_ranges: int = 0,
+                num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+@overload
+def compact(
+    hashs: numpy.ndarray[numpy.uint64],
+    precision: int = 64
+) -> Tuple[numpy.ndarray[numpy.uint64], numpy.ndarray[numpy.uint32]]:
+    ...
+
+
+@overload
+def compact(
+    hashs: numpy.ndarray[numpy.uint64], precisions: numpy.ndarray[numpy.uint32]
+) -> Tuple[numpy.ndarray[numpy.uint64], numpy.ndarray[numpy.uint32]]:
+    ...
+
+
+def expand(hashs: numpy.ndarray[numpy.uint64],
+           precisions: numpy.ndarray[numpy.uint32],
+           precision: int = 64,
+           num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
     ...
 
 
@@ -19,7 +104,26 @@ def decode(hash: int, precision: int = 64, round: bool = False):
 
 def decode(hashs: numpy.ndarray[numpy.uint64],
            precision: int = 64,
-           round: bool = False) -> numpy.ndarray[Point]:
+           round: bool = False,
+           num_threads: int = 0) -> numpy.ndarray[Point]:
+    ...
+
+
+@overload
+def decode_lnglat(
+        hashs: numpy.ndarray[numpy.uint64],
+        precision: int = 64,
+        round: bool = False,
+        num_threads: int = 0) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+def decode_lnglat(hashs: numpy.ndarray[numpy.uint64],
+                  lng: numpy.ndarray,
+                  lat: numpy.ndarray,
+                  precision: int = 64,
+                  round: bool = False,
+                  num_threads: int = 0) -> None:
     ...
 
 
@@ -28,8 +132,17 @@ def encode(point: Point, precision: int = 64) -> int:
     ...
 
 
+@overload
 def encode(points: numpy.ndarray[Point],
-           precision: int = 64) -> numpy.ndarray[numpy.uint64]:
+           precision: int = 64,
+           num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+def encode(lng: numpy.ndarray,
+           lat: numpy.ndarray,
+           precision: int = 64,
+           num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
     ...
 
 
@@ -42,5 +155,90 @@ def grid_properties(box: Optional[Box] = None,
     ...
 
 
+@overload
+def k_ring(hash: int, k: int = 1,
+           precision: int = 64) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+def k_ring(hashs: numpy.ndarray[numpy.uint64],
+           k: int = 1,
+           precision: int = 64,
+           num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+@overload
 def neighbors(box: int, precision: int = 64) -> numpy.ndarray[numpy.uint64]:
     ...
+
+
+def neighbors(hashs: numpy.ndarray[numpy.uint64],
+              precision: int = 64,
+              num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
+    ...
+
+
+class Cover:
+    def __init__(self,
+                 box: Optional[Box] = None,
+                 precision: int = 5,
+                 chunk_size: int = 1048576) -> None:
+        ...
+
+    def __iter__(self) -> Iterator[numpy.ndarray[numpy.uint64]]:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+    def __next__(self) -> numpy.ndarray[numpy.uint64]:
+        ...
+
+    @property
+    def chunk_size(self) -> int:
+        ...
+
+    @property
+    def cursor(self) -> int:
+        ...
+
+    @cursor.setter
+    def cursor(self, cursor: int) -> None:
+        ...
+
+    def next(self, num_threads: int = 0) -> numpy.ndarray[numpy.uint64]:
+        ...
+
+
+def where(
+    hash: numpy.ndarray[numpy.uint64],
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray[numpy.uint64], numpy.ndarray[numpy.int64],
+           numpy.ndarray[numpy.int64], numpy.ndarray[numpy.int64],
+           numpy.ndarray[numpy.int64]]:
+    ...
+
+
+@overload
+def argsort(
+    hashs: numpy.ndarray[numpy.uint64],
+    precision: int = 64,
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray[numpy.int64], numpy.ndarray[numpy.uint64]]:
+    ...
+
+
+def argsort(
+    lng: numpy.ndarray,
+    lat: numpy.ndarray,
+    precision: int = 64,
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray[numpy.int64], numpy.ndarray[numpy.uint64]]:
+    ...
+
+
+def permute(values: numpy.ndarray,
+            permutation: numpy.ndarray[numpy.int64],
+            num_threads: int = 0) -> None:
+    ...
@@ -0,0 +1,79 @@
+#include "geohash/cpu.hpp"
+
+#include <cstdint>
+
+#if defined(GEOHASH_X86_64) && defined(_WIN32)
+#include <intrin.h>
+
+#include <array>
+#endif
+
+namespace geohash::cpu {
+
+#ifdef GEOHASH_X86_64
+#ifdef _WIN32
+// Returns true if the OS saves the state of the registers given by the mask.
+static auto os_supports(const uint64_t mask) noexcept -> bool {
+  auto registers = std::array<int, 4>();
+  __cpuid(registers.data(), 1);
+  // OSXSAVE
+  if ((registers[2] & (1 << 27)) == 0) {
+    return false;
+  }
+  return (_xgetbv(0) & mask) == mask;
+}
+
+// Returns the EBX register of the extended features flags.
+static auto extended_features() noexcept -> uint32_t {
+  auto registers = std::array<int, 4>();
+  __cpuidex(registers.data(), 7, 0);
+  return static_cast<uint32_t>(registers[1]);
+}
+
+// ---------------------------------------------------------------------------
+auto has_bmi2() noexcept -> bool {
+  return (extended_features() & (1U << 8U)) != 0;
+}
+
+// ---------------------------------------------------------------------------
+auto has_avx2() noexcept -> bool {
+  // XMM & YMM states
+  return os_supports(0x6) && (extended_features() & (1U << 5U)) != 0;
+}
+
+// ---------------------------------------------------------------------------
+auto has_avx512f() noexcept -> bool {
+  // XMM, YMM, opmask and ZMM states
+  return os_supports(0xe6) && (extended_features() & (1U << 16U)) != 0;
+}
+#else
+// ---------------------------------------------------------------------------
+auto has_bmi2() noexcept -> bool {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi2") != 0;
+}
+
+// ---------------------------------------------------------------------------
+auto has_avx2() noexcept -> bool {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+// ---------------------------------------------------------------------------
+auto has_avx512f() noexcept -> bool {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") != 0;
+}
+#endif
+#else
+// ---------------------------------------------------------------------------
+auto has_bmi2() noexcept -> bool { return false; }
+
+// ---------------------------------------------------------------------------
+auto has_avx2() noexcept -> bool { return false; }
+
+// ---------------------------------------------------------------------------
+auto has_avx512f() noexcept -> bool { return false; }
+#endif
+
+}  // namespace geohash::cpu
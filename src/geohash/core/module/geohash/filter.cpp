@@ -0,0 +1,213 @@
+#include "geohash/filter.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "geohash/kernel.hpp"
+#include "geohash/parallel.hpp"
+
+namespace geohash::filter {
+
+// ---------------------------------------------------------------------------
+auto contains(const Box& box,
+              const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
+              const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+  auto result = Eigen::Matrix<bool, -1, 1>(points.size());
+  const auto& kernel = kernel::current();
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        kernel.box_contains_points(points.data() + start, end - start, box,
+                                   result.data() + start);
+      },
+      static_cast<size_t>(points.size()), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto contains(const Box& box, const int64::Coordinates<T>& lng,
+              const int64::Coordinates<T>& lat, const size_t num_threads)
+    -> Eigen::Matrix<bool, -1, 1> {
+  if (lng.size() != lat.size()) {
+    throw std::invalid_argument("lng and lat must have the same size");
+  }
+  auto result = Eigen::Matrix<bool, -1, 1>(lng.size());
+  // The batch functions of the kernels only handle contiguous vectors of
+  // doubles.
+  const auto contiguous = std::is_same_v<T, double> &&
+                          lng.innerStride() == 1 && lat.innerStride() == 1;
+  const auto& kernel = kernel::current();
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        if constexpr (std::is_same_v<T, double>) {
+          if (contiguous) {
+            kernel.box_contains_lnglat(lng.data() + start, lat.data() + start,
+                                       end - start, box,
+                                       result.data() + start);
+            return;
+          }
+        }
+        for (auto ix = start; ix < end; ++ix) {
+          result(ix) = box.contains(
+              {static_cast<double>(lng(ix)), static_cast<double>(lat(ix))});
+        }
+      },
+      static_cast<size_t>(lng.size()), num_threads);
+  return result;
+}
+
+template auto contains<double>(const Box&, const int64::Coordinates<double>&,
+                               const int64::Coordinates<double>&, size_t)
+    -> Eigen::Matrix<bool, -1, 1>;
+template auto contains<float>(const Box&, const int64::Coordinates<float>&,
+                              const int64::Coordinates<float>&, size_t)
+    -> Eigen::Matrix<bool, -1, 1>;
+
+// ---------------------------------------------------------------------------
+PreparedPolygon::PreparedPolygon(const Polygon& polygon) {
+  check_antimeridian(polygon);
+  auto lng_min = std::numeric_limits<double>::max();
+  auto lat_min = std::numeric_limits<double>::max();
+  auto lng_max = std::numeric_limits<double>::lowest();
+  auto lat_max = std::numeric_limits<double>::lowest();
+
+  // The rings may be closed or not: the edge closing a closed ring joins two
+  // identical points and is ignored like the edges parallel to the equator,
+  // which are never crossed by the rays cast along the parallels.
+  auto add_ring = [&](const auto& ring) {
+    for (size_t ix = 0; ix < ring.size(); ++ix) {
+      const auto& p = ring[ix];
+      const auto& q = ring[(ix + 1) % ring.size()];
+      lng_min = std::min(lng_min, p.lng);
+      lat_min = std::min(lat_min, p.lat);
+      lng_max = std::max(lng_max, p.lng);
+      lat_max = std::max(lat_max, p.lat);
+      if (p.lat != q.lat) {
+        edges_.push_back({std::min(p.lat, q.lat), std::max(p.lat, q.lat),
+                          p.lng, p.lat, (q.lng - p.lng) / (q.lat - p.lat)});
+      }
+    }
+  };
+  add_ring(polygon.outer());
+  for (const auto& item : polygon.inners()) {
+    add_ring(item);
+  }
+  if (edges_.empty()) {
+    // Empty or flat polygon: no point is inside.
+    offsets_ = {0, 0};
+    return;
+  }
+  envelope_ = Box({lng_min, lat_min}, {lng_max, lat_max});
+
+  // One band per edge, on average, up to a limit.
+  constexpr size_t max_bands = 1 << 16;
+  // Maximum number of copies of the edges, on average per edge.
+  constexpr size_t max_copies = 4;
+  auto bands = std::min(edges_.size(), max_bands);
+  auto band = [&](const double lat) -> size_t {
+    return std::min(static_cast<size_t>((lat - lat_min) * scale_), bands - 1);
+  };
+
+  // The edges are sorted by bands, an edge being repeated in each band it
+  // crosses. The number of bands is halved until the number of copies is
+  // bounded, the long edges, such as those of a band of latitudes, crossing
+  // most bands.
+  for (;;) {
+    scale_ = static_cast<double>(bands) / (lat_max - lat_min);
+    auto copies = size_t(0);
+    for (const auto& item : edges_) {
+      copies += band(item.lat_max) - band(item.lat_min) + 1;
+    }
+    if (bands == 1 || copies <= max_copies * edges_.size()) {
+      break;
+    }
+    bands /= 2;
+  }
+  offsets_.resize(bands + 1, 0);
+  for (const auto& item : edges_) {
+    for (auto ix = band(item.lat_min); ix <= band(item.lat_max); ++ix) {
+      ++offsets_[ix + 1];
+    }
+  }
+  for (size_t ix = 0; ix < bands; ++ix) {
+    offsets_[ix + 1] += offsets_[ix];
+  }
+  auto edges = std::vector<Edge>(offsets_.back());
+  auto position = std::vector<size_t>(offsets_.begin(), offsets_.end() - 1);
+  for (const auto& item : edges_) {
+    for (auto ix = band(item.lat_min); ix <= band(item.lat_max); ++ix) {
+      edges[position[ix]++] = item;
+    }
+  }
+  edges_ = std::move(edges);
+}
+
+// ---------------------------------------------------------------------------
+auto PreparedPolygon::contains(const Point& point) const -> bool {
+  // The comparisons are false for NaN.
+  if (!(envelope_.min_corner().lat <= point.lat &&
+        point.lat <= envelope_.max_corner().lat &&
+        envelope_.min_corner().lng <= point.lng &&
+        point.lng <= envelope_.max_corner().lng)) {
+    return false;
+  }
+  const auto band = std::min(
+      static_cast<size_t>((point.lat - envelope_.min_corner().lat) * scale_),
+      offsets_.size() - 2);
+  auto inside = false;
+  for (auto ix = offsets_[band]; ix < offsets_[band + 1]; ++ix) {
+    const auto& edge = edges_[ix];
+    if (edge.lat_min <= point.lat && point.lat < edge.lat_max &&
+        point.lng < edge.lng + (point.lat - edge.lat0) * edge.slope) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// ---------------------------------------------------------------------------
+auto PreparedPolygon::contains(
+    const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
+    const size_t num_threads) const -> Eigen::Matrix<bool, -1, 1> {
+  auto result = Eigen::Matrix<bool, -1, 1>(points.size());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          result(ix) = contains(points(ix));
+        }
+      },
+      static_cast<size_t>(points.size()), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto PreparedPolygon::contains(const int64::Coordinates<T>& lng,
+                               const int64::Coordinates<T>& lat,
+                               const size_t num_threads) const
+    -> Eigen::Matrix<bool, -1, 1> {
+  if (lng.size() != lat.size()) {
+    throw std::invalid_argument("lng and lat must have the same size");
+  }
+  auto result = Eigen::Matrix<bool, -1, 1>(lng.size());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          result(ix) = contains(
+              {static_cast<double>(lng(ix)), static_cast<double>(lat(ix))});
+        }
+      },
+      static_cast<size_t>(lng.size()), num_threads);
+  return result;
+}
+
+template auto PreparedPolygon::contains<double>(
+    const int64::Coordinates<double>&, const int64::Coordinates<double>&,
+    size_t) const -> Eigen::Matrix<bool, -1, 1>;
+template auto PreparedPolygon::contains<float>(
+    const int64::Coordinates<float>&, const int64::Coordinates<float>&,
+    size_t) const -> Eigen::Matrix<bool, -1, 1>;
+
+}  // namespace geohash::filter
@@ -1,228 +1,773 @@
 #include "geohash/int64.hpp"
 
+#include <algorithm>
 #include <array>
-#include <iostream>
+#include <boost/geometry/geometries/point_xy.hpp>
+#include <boost/geometry/geometries/segment.hpp>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "geohash/kernel.hpp"
+#include "geohash/parallel.hpp"
 
 // Ref: https://mmcloughlin.com/posts/geohash-assembly
 namespace geohash::int64 {
 namespace detail {
 
-static constexpr auto exp232 = 4294967296.0;      // 2^32;
-static constexpr auto inv_exp232 = 1.0 / exp232;  // 1 / 2^32;
-
-// Returns true if the CPU supports Bit Manipulation Instruction Set 2 (BMI2)
-inline auto has_bmi2() noexcept -> bool {
-#ifdef _WIN32
-  auto registers = std::array<int, 4>();
-  __cpuidex(registers.data(), 7, 0);
-  return (registers[1] & (1U << 8U)) != 0;
-#else
-  uint32_t ebx;
-  asm("movl $7, %%eax;"
-      "movl $0, %%ecx;"
-      "cpuid;"
-      "movl %%ebx, %0;"
-      : "=r"(ebx)
-      :
-      : "eax", "ecx", "ebx");
-  return (ebx & (1U << 8U)) != 0;
-#endif
-}
-
-// Spread out the 32 bits of x into 64 bits, where the bits of x occupy even
-// bit positions.
-inline constexpr auto spread(const uint32_t x) -> uint64_t {
-  auto result = static_cast<uint64_t>(x);
-  result = (result | (result << 16U)) & 0X0000FFFF0000FFFFUL;
-  result = (result | (result << 8U)) & 0X00FF00FF00FF00FFUL;
-  result = (result | (result << 4U)) & 0X0F0F0F0F0F0F0F0FUL;
-  result = (result | (result << 2U)) & 0X3333333333333333UL;
-  result = (result | (result << 1U)) & 0X5555555555555555UL;
-  return result;
+// Bits of a geohash of a given precision holding the longitude and the
+// latitude. The most significant bit of a hash always encodes the longitude,
+// so the position of the bits depends on the parity of the precision.
+struct Layout {
+  explicit constexpr Layout(const uint32_t precision)
+      : lng_shift((precision & 1U) != 0 ? 0 : 1), lat_shift(lng_shift ^ 1U) {
+    auto all = precision == 64 ? ~uint64_t(0)
+                               : (uint64_t(1) << precision) - uint64_t(1);
+    lng = (0x5555555555555555UL << lng_shift) & all;
+    lat = (0x5555555555555555UL << lat_shift) & all;
+  }
+
+  // Spreads a number of columns over the longitude bits. The result is
+  // reduced modulo the number of columns.
+  [[nodiscard]] constexpr auto dilate_lng(const uint32_t x) const
+      -> uint64_t {
+    return (kernel::spread(x) << lng_shift) & lng;
+  }
+
+  // Spreads a number of rows over the latitude bits. The result is not
+  // reduced, so that it can be compared to the number of rows available.
+  [[nodiscard]] constexpr auto dilate_lat(const uint32_t x) const
+      -> uint64_t {
+    return kernel::spread(x) << lat_shift;
+  }
+
+  uint32_t lng_shift;
+  uint32_t lat_shift;
+  uint64_t lng{};
+  uint64_t lat{};
+};
+
+// Adds the dilated integers x and y stored in the bits selected by mask. The
+// bits outside the mask are set so that the carries propagate across them.
+inline constexpr auto dilated_add(const uint64_t x, const uint64_t y,
+                                  const uint64_t mask) -> uint64_t {
+  return ((x | ~mask) + (y & mask)) & mask;
 }
 
-// Squash the even bitlevels of X into a 32-bit word. Odd bitlevels of X are
-// ignored, and may take any value.
-inline constexpr auto squash(uint64_t x) -> uint32_t {
-  x &= 0x5555555555555555UL;
-  x = (x | (x >> 1U)) & 0X3333333333333333UL;
-  x = (x | (x >> 2U)) & 0X0F0F0F0F0F0F0F0FUL;
-  x = (x | (x >> 4U)) & 0X00FF00FF00FF00FFUL;
-  x = (x | (x >> 8U)) & 0X0000FFFF0000FFFFUL;
-  x = (x | (x >> 16U)) & 0X00000000FFFFFFFFUL;
-  return static_cast<uint32_t>(x);
+// Subtracts the dilated integer y from x, both stored in the bits selected
+// by mask.
+inline constexpr auto dilated_sub(const uint64_t x, const uint64_t y,
+                                  const uint64_t mask) -> uint64_t {
+  return ((x & mask) - (y & mask)) & mask;
 }
 
-// Interleave the bits of x and y. In the result, x and y occupy even and odd
-// bitlevels, respectively.
-inline constexpr auto interleave(const uint32_t x, const uint32_t y)
+// Moves the cell by dx columns and dy rows. Longitudes wrap around the
+// antimeridian, latitudes saturate at the poles.
+inline constexpr auto move(const uint64_t hash, const int64_t dx,
+                           const int64_t dy, const Layout& layout)
     -> uint64_t {
-  return spread(x) | (spread(y) << 1U);
+  auto lng = hash & layout.lng;
+  auto lat = hash & layout.lat;
+  if (dx > 0) {
+    lng = dilated_add(lng, layout.dilate_lng(static_cast<uint32_t>(dx)),
+                      layout.lng);
+  } else if (dx < 0) {
+    lng = dilated_sub(lng, layout.dilate_lng(static_cast<uint32_t>(-dx)),
+                      layout.lng);
+  }
+  if (dy > 0) {
+    auto step = layout.dilate_lat(static_cast<uint32_t>(dy));
+    // layout.lat ^ lat is the number of rows remaining to the north.
+    lat = step > (layout.lat ^ lat) ? layout.lat
+                                    : dilated_add(lat, step, layout.lat);
+  } else if (dy < 0) {
+    auto step = layout.dilate_lat(static_cast<uint32_t>(-dy));
+    lat = step > lat ? 0 : dilated_sub(lat, step, layout.lat);
+  }
+  return lng | lat;
 }
 
-// Deinterleave the bits of X into 32-bit words containing the even and odd
-// bitlevels of X, respectively.
-inline auto deinterleave(const uint64_t x) -> std::tuple<uint32_t, uint32_t> {
-  return std::make_tuple(squash(x), squash(x >> 1U));
+// Writes the cells within the Chebyshev distance k of hash: the cell itself,
+// then each ring clockwise starting from the north.
+inline auto k_ring(const uint64_t hash, const int64_t k, const Layout& layout,
+                   uint64_t* result) -> void {
+  *(result++) = hash;
+  for (int64_t r = 1; r <= k; ++r) {
+    for (int64_t dx = 0; dx <= r; ++dx) {
+      *(result++) = move(hash, dx, r, layout);
+    }
+    for (int64_t dy = r - 1; dy >= -r; --dy) {
+      *(result++) = move(hash, r, dy, layout);
+    }
+    for (int64_t dx = r - 1; dx >= -r; --dx) {
+      *(result++) = move(hash, dx, -r, layout);
+    }
+    for (int64_t dy = -r + 1; dy <= r; ++dy) {
+      *(result++) = move(hash, -r, dy, layout);
+    }
+    for (int64_t dx = -r + 1; dx < 0; ++dx) {
+      *(result++) = move(hash, dx, r, layout);
+    }
+  }
 }
 
-// Encode the position of x within the range -r to +r as a 32-bit integer.
-inline constexpr auto encode_range(const double x, const double r) -> uint32_t {
-  if (x >= r) {
-    return std::numeric_limits<uint32_t>::max();
+// Checks that the rings of distance k fit in the grid of cells at the given
+// precision, and that their number of cells fits in a size_t.
+inline auto check_k_ring(const uint32_t precision, const uint32_t k) -> void {
+  // The longitudes are encoded on the largest half of the bits.
+  const auto columns = uint64_t(1) << ((precision + 1) / 2);
+  const auto max_k = std::min<uint64_t>(
+      columns, (std::numeric_limits<uint32_t>::max() - 1) / 2);
+  if (k > max_k) {
+    throw std::invalid_argument("k must be within [0, " +
+                                std::to_string(max_k) + "]");
   }
-  auto p = (x + r) / (2 * r);
-  return static_cast<uint32_t>(p * exp232);
 }
 
-// Decode the 32-bit range encoding X back to a value in the range -r to +r.
-inline constexpr auto decode_range(const uint32_t x, const double r) -> double {
-  if (x == std::numeric_limits<uint32_t>::max()) {
-    return r;
+// Point, segment and polygon in the longitude/latitude plane.
+using PlanarPoint = boost::geometry::model::d2::point_xy<double>;
+using PlanarBox = boost::geometry::model::box<PlanarPoint>;
+using PlanarSegment = boost::geometry::model::segment<PlanarPoint>;
+using PlanarPolygon = boost::geometry::model::polygon<PlanarPoint>;
+
+// Computes the cells covering a polygon by refining, from a coarse precision,
+// only the cells crossed by its edges.
+class PolygonCoverer {
+ public:
+  PolygonCoverer(const Polygon& polygon, const uint32_t precision)
+      : precision_(precision) {
+    check_antimeridian(polygon);
+    auto copy = [](const auto& source, auto& target) {
+      for (const auto& item : source) {
+        boost::geometry::append(target, PlanarPoint(item.lng, item.lat));
+      }
+    };
+    copy(polygon.outer(), polygon_.outer());
+    polygon_.inners().resize(polygon.inners().size());
+    for (size_t ix = 0; ix < polygon.inners().size(); ++ix) {
+      copy(polygon.inners()[ix], polygon_.inners()[ix]);
+    }
+    // Closes the rings, if necessary, before listing the edges.
+    boost::geometry::correct(polygon_);
+    boost::geometry::for_each_segment(polygon_, [this](const auto& segment) {
+      edges_.emplace_back(PlanarPoint(boost::geometry::get<0, 0>(segment),
+                                      boost::geometry::get<0, 1>(segment)),
+                          PlanarPoint(boost::geometry::get<1, 0>(segment),
+                                      boost::geometry::get<1, 1>(segment)));
+    });
   }
-  auto p = static_cast<double>(x) * inv_exp232;
-  return 2 * r * p - r;
-}
 
-// Encode the position a 64-bit integer
-inline constexpr auto encode(const double lat, const double lng) -> uint64_t {
-  return interleave(encode_range(lat, 90), encode_range(lng, 180));
-}
+  // Returns the envelope of the polygon.
+  [[nodiscard]] auto envelope() const -> Box {
+    auto box = PlanarBox();
+    boost::geometry::envelope(polygon_, box);
+    return {{box.min_corner().x(), box.min_corner().y()},
+            {box.max_corner().x(), box.max_corner().y()}};
+  }
 
-inline auto shrq(const double x) -> uint64_t {
-  uint64_t result;
-#ifdef _WIN32
-  result = _mm_cvtsi128_si64(_mm_castpd_si128(_mm_loaddup_pd(&x))) >> 20U;
-#else
-  asm("movd %1, %%xmm0;"
-      "movq %%xmm0, %%r8;"
-      "shrq $20, %%r8;"
-      "movq %%r8, %0;"
-      : "=r"(result)
-      : "r"(x)
-      : "r8", "xmm0");
-#endif
-  return result;
+  // Visits the cells covering the polygon contained in the cell "hash" of
+  // precision "level": "inside(code, level)" is called for the cells within
+  // the polygon, which are not refined, and "boundary(code)" for the cells of
+  // the target precision crossing one of its edges. The cells are visited in
+  // ascending order. "edges" are the edges of the polygon that may cross the
+  // cell.
+  template <typename Inside, typename Boundary>
+  auto refine(const uint64_t hash, const uint32_t level,
+              const std::vector<PlanarSegment>& edges, Inside& inside,
+              Boundary& boundary) const -> void {
+    const auto box = bounding_box(hash, level);
+    const auto cell = PlanarBox(
+        PlanarPoint(box.min_corner().lng, box.min_corner().lat),
+        PlanarPoint(box.max_corner().lng, box.max_corner().lat));
+
+    auto crossing = std::vector<PlanarSegment>();
+    for (const auto& item : edges) {
+      if (boost::geometry::intersects(item, cell)) {
+        crossing.push_back(item);
+      }
+    }
+
+    if (crossing.empty()) {
+      // No edge crosses the cell: it is entirely inside or outside.
+      const auto center = box.center();
+      if (boost::geometry::within(PlanarPoint(center.lng, center.lat),
+                                  polygon_)) {
+        inside(hash, level);
+      }
+      return;
+    }
+    if (level == precision_) {
+      boundary(hash);
+      return;
+    }
+    const auto bits = std::min(precision_ - level, 5U);
+    for (uint64_t ix = 0; ix < (uint64_t(1) << bits); ++ix) {
+      refine((hash << bits) | ix, level + bits, crossing, inside, boundary);
+    }
+  }
+
+  // Returns the sorted cells from which the refinement starts and their
+  // precision. The coarsest precision whose grid covering the envelope has
+  // enough cells to be distributed among the threads is chosen.
+  [[nodiscard]] auto top_level_cells() const
+      -> std::tuple<std::vector<uint64_t>, uint32_t> {
+    constexpr size_t min_cells = 256;
+
+    const auto box = envelope();
+    auto level = std::min(precision_, 5U);
+    while (level < precision_ && Grid(box, level).size() < min_cells) {
+      level = std::min(level + 5, precision_);
+    }
+    const auto grid = Grid(box, level);
+    auto cells = std::vector<uint64_t>(grid.size());
+    grid.codes(0, grid.size(), cells.data(), 1);
+    std::sort(cells.begin(), cells.end());
+    return std::make_tuple(std::move(cells), level);
+  }
+
+  // Returns all the edges of the polygon.
+  [[nodiscard]] auto edges() const -> const std::vector<PlanarSegment>& {
+    return edges_;
+  }
+
+ private:
+  uint32_t precision_;
+  PlanarPolygon polygon_{};
+  std::vector<PlanarSegment> edges_{};
+};
+
+// Mean radius of the Earth, in meters.
+constexpr double kEarthRadius = 6371008.8;
+
+// Computes the great-circle distances between a point and the cells. On a
+// meridian, the distance to the point varies as the cosine of the latitude
+// shifted by a constant, so its extrema over the edge of a cell are at the
+// ends of the edge or at one stationary latitude. For a given latitude, the
+// distance only grows with the difference of longitude, so the extrema over a
+// cell are found on the meridian of the cell closest to, or farthest from,
+// the point.
+class CellDistance {
+ public:
+  explicit CellDistance(const Point& point)
+      : lng_(radians(point.lng)),
+        lat_(radians(point.lat)),
+        sin_lat_(std::sin(lat_)),
+        cos_lat_(std::cos(lat_)) {}
+
+  // Returns the minimum and maximum distances, in meters, between the point
+  // and the points of the box.
+  [[nodiscard]] auto operator()(const Box& box) const
+      -> std::tuple<double, double> {
+    constexpr auto pi = 3.14159265358979323846;
+    const auto lng0 = radians(box.min_corner().lng);
+    const auto span = radians(box.max_corner().lng) - lng0;
+    const auto lat0 = radians(box.min_corner().lat);
+    const auto lat1 = radians(box.max_corner().lat);
+    const auto west = std::abs(std::remainder(lng0 - lng_, 2 * pi));
+    const auto east = std::abs(std::remainder(lng0 + span - lng_, 2 * pi));
+
+    // Is the meridian of the point, or its antimeridian, crossing the box?
+    auto crosses = [&](const double lng) -> bool {
+      auto delta = std::remainder(lng - lng0, 2 * pi);
+      return (delta < 0 ? delta + 2 * pi : delta) <= span;
+    };
+    const auto nearest = crosses(lng_) ? 0.0 : std::min(west, east);
+    const auto farthest = crosses(lng_ + pi) ? pi : std::max(west, east);
+
+    auto min_angle = std::min(angle(nearest, lat0), angle(nearest, lat1));
+    auto lat = std::atan2(sin_lat_, cos_lat_ * std::cos(nearest));
+    if (lat0 <= lat && lat <= lat1) {
+      min_angle = std::min(min_angle, angle(nearest, lat));
+    }
+    auto max_angle = std::max(angle(farthest, lat0), angle(farthest, lat1));
+    lat = std::atan2(-sin_lat_, -cos_lat_ * std::cos(farthest));
+    if (lat0 <= lat && lat <= lat1) {
+      max_angle = std::max(max_angle, angle(farthest, lat));
+    }
+    return std::make_tuple(min_angle * kEarthRadius, max_angle * kEarthRadius);
+  }
+
+ private:
+  double lng_;
+  double lat_;
+  double sin_lat_;
+  double cos_lat_;
+
+  static constexpr auto radians(const double x) -> double {
+    return x * (3.14159265358979323846 / 180.0);
+  }
+
+  // Returns the central angle between the point and the point of latitude
+  // "lat" separated by "delta" radians of longitude (haversine formula).
+  [[nodiscard]] auto angle(const double delta, const double lat) const
+      -> double {
+    const auto dlat = std::sin((lat - lat_) * 0.5);
+    const auto dlng = std::sin(delta * 0.5);
+    const auto h = dlat * dlat + cos_lat_ * std::cos(lat) * dlng * dlng;
+    return 2 * std::asin(std::min(std::sqrt(h), 1.0));
+  }
+};
+
+// A cell of a circle cover: its minimum and maximum distances to the center
+// of the circle and its code.
+using CircleCell = std::tuple<double, double, uint64_t>;
+
+// Appends to "cells" the cells of the target precision contained in the cell
+// "hash" of precision "level" that are within "radius" meters of the point.
+inline auto refine_circle(const CellDistance& distance, const double radius,
+                          const uint64_t hash, const uint32_t level,
+                          const uint32_t precision,
+                          std::vector<CircleCell>& cells) -> void {
+  double min_distance;
+  double max_distance;
+  std::tie(min_distance, max_distance) = distance(bounding_box(hash, level));
+  if (min_distance > radius) {
+    return;
+  }
+  if (level == precision) {
+    cells.emplace_back(min_distance, max_distance, hash);
+    return;
+  }
+  const auto bits = std::min(precision - level, 5U);
+  for (uint64_t ix = 0; ix < (uint64_t(1) << bits); ++ix) {
+    refine_circle(distance, radius, (hash << bits) | ix, level + bits,
+                  precision, cells);
+  }
 }
 
-inline auto pdepq(const uint64_t x, const uint64_t y) -> uint64_t {
-  uint64_t result;
-#ifdef _WIN32
-  result = _pdep_u64(x, y);
-#else
-  asm("movq %1, %%r9;"
-      "movq %2, %%r8;"
-      "pdepq %%r9, %%r8, %%r10;"
-      "movq %%r10, %0;"
-      : "=r"(result)
-      : "r"(y), "r"(x)
-      : "r8", "r9", "r10");
-#endif
-  return result;
+// Intervals [start, end) of codes.
+using Ranges = std::vector<std::array<uint64_t, 2>>;
+
+// Appends the interval [start, end) to the sorted intervals, merging it with
+// the last one if they are contiguous.
+inline auto append_range(Ranges& ranges, const uint64_t start,
+                         const uint64_t end) -> void {
+  if (!ranges.empty() && ranges.back()[1] == start) {
+    ranges.back()[1] = end;
+  } else {
+    ranges.push_back({start, end});
+  }
 }
 
-inline auto pextq(const uint64_t x, const uint64_t y) -> uint64_t {
-  uint64_t result;
-#ifdef _WIN32
-  result = _pext_u64(x, y);
-#else
-  asm("movq %1, %%r9;"
-      "movq %2, %%r8;"
-      "pextq %%r9, %%r8, %%r10;"
-      "movq %%r10, %0;"
-      : "=r"(result)
-      : "r"(y), "r"(x)
-      : "r8", "r9", "r10");
-#endif
-  return result;
+// Appends the intervals of the codes of the rectangle of cells [x0, x1] x
+// [y0, y1] contained in the cell "hash" whose codes have "bits" unknown
+// bits. The cell is split in two halves, along the longitude or the latitude
+// depending on the next bit, until it is inside or outside the rectangle.
+inline auto rectangle_ranges(const uint64_t hash, const uint32_t bits,
+                             const std::array<uint32_t, 4>& rectangle,
+                             const Layout& layout, Ranges& ranges) -> void {
+  const auto first = bits == 64 ? 0 : hash << bits;
+  const auto last = first | (bits == 64 ? ~uint64_t(0)
+                                        : (uint64_t(1) << bits) - 1);
+  auto x = [&](const uint64_t code) {
+    return kernel::squash((code & layout.lng) >> layout.lng_shift);
+  };
+  auto y = [&](const uint64_t code) {
+    return kernel::squash((code & layout.lat) >> layout.lat_shift);
+  };
+  const auto x0 = x(first);
+  const auto x1 = x(last);
+  const auto y0 = y(first);
+  const auto y1 = y(last);
+  if (x1 < rectangle[0] || x0 > rectangle[1] || y1 < rectangle[2] ||
+      y0 > rectangle[3]) {
+    return;
+  }
+  if (x0 >= rectangle[0] && x1 <= rectangle[1] && y0 >= rectangle[2] &&
+      y1 <= rectangle[3]) {
+    append_range(ranges, first, last + 1);
+    return;
+  }
+  rectangle_ranges(hash << 1U, bits - 1, rectangle, layout, ranges);
+  rectangle_ranges((hash << 1U) | 1U, bits - 1, rectangle, layout, ranges);
 }
 
-static auto encode_bim2(const double lat, const double lng) -> uint64_t {
-  auto y = pdepq(
-      lat == 90.0 ? 0X3FFFFFFFFFF : shrq(1.5 + (lat * 0.005555555555555556)),
-      0x5555555555555555);
-  auto x = pdepq(
-      lng == 180.0 ? 0X3FFFFFFFFFF : shrq(1.5 + (lng * 0.002777777777777778)),
-      0x5555555555555555);
-  return (x << 1U) | y;
+// Merges the intervals separated by the smallest gaps until at most
+// "max_ranges" intervals remain, and returns them as a matrix.
+inline auto limit_ranges(const Ranges& ranges, const size_t max_ranges)
+    -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor> {
+  // Gaps kept between the intervals.
+  auto kept = std::vector<bool>(ranges.size(), true);
+  if (max_ranges != 0 && ranges.size() > max_ranges) {
+    auto gaps = std::vector<size_t>(ranges.size() - 1);
+    for (size_t ix = 0; ix < gaps.size(); ++ix) {
+      gaps[ix] = ix;
+    }
+    std::sort(gaps.begin(), gaps.end(), [&](const size_t a, const size_t b) {
+      const auto gap_a = ranges[a + 1][0] - ranges[a][1];
+      const auto gap_b = ranges[b + 1][0] - ranges[b][1];
+      return gap_a > gap_b || (gap_a == gap_b && a < b);
+    });
+    std::fill(kept.begin(), kept.end(), false);
+    for (size_t ix = 0; ix < max_ranges - 1; ++ix) {
+      kept[gaps[ix]] = true;
+    }
+    kept.back() = true;
+  }
+  auto result = Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor>(
+      std::count(kept.begin(), kept.end(), true), 2);
+  auto row = Eigen::Index(0);
+  auto start = ranges.empty() ? 0 : ranges.front()[0];
+  for (size_t ix = 0; ix < ranges.size(); ++ix) {
+    if (kept[ix]) {
+      result(row, 0) = start;
+      result(row++, 1) = ranges[ix][1];
+      if (ix + 1 < ranges.size()) {
+        start = ranges[ix + 1][0];
+      }
+    }
+  }
+  return result;
 }
 
-static auto deinterleave_bim2(const uint64_t x)
-    -> std::tuple<uint32_t, uint32_t> {
-  auto lat = pextq(x, 0x5555555555555555);
-  auto lng = pextq(x, 0XAAAAAAAAAAAAAAAA);
+// Sorts "size" codes, and the permutation sorting them, with a parallel LSD
+// radix sort of 8-bit digits on the "bits" lower bits of the codes.
+// "fill(start, end, codes)" writes the codes of the items [start, end). The
+// items are split into one chunk per thread, used by all the passes, and the
+// chunk filled by a thread is counted while it is still in its cache.
+template <typename Fill>
+auto radix_argsort(const size_t size, const uint32_t bits,
+                   const size_t num_threads, const Fill& fill)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>> {
+  using Histogram = std::array<size_t, 256>;
 
-  return std::make_tuple(static_cast<uint32_t>(lat),
-                         static_cast<uint32_t>(lng));
-}
-}  // namespace detail
+  const auto chunks = parallel::num_workers(size, num_threads);
+  const auto chunk_size = (size + chunks - 1) / chunks;
+  auto codes = Eigen::Matrix<uint64_t, -1, 1>(size);
+  auto index = Eigen::Matrix<int64_t, -1, 1>(size);
+  auto codes_tmp = Eigen::Matrix<uint64_t, -1, 1>(size);
+  auto index_tmp = Eigen::Matrix<int64_t, -1, 1>(size);
+  auto histograms = std::vector<Histogram>(chunks);
 
-// Pointer to the GeoHash position encoding function.
-using encoder_t = uint64_t (*)(double, double);
+  // Runs "worker(start, end, histogram)" on each chunk.
+  auto for_each_chunk = [&](const auto& worker) {
+    parallel::dispatch(
+        [&](const size_t first, const size_t last) {
+          for (auto ix = first; ix < last; ++ix) {
+            const auto start = std::min(ix * chunk_size, size);
+            worker(start, std::min(start + chunk_size, size), histograms[ix]);
+          }
+        },
+        chunks, num_threads, 1);
+  };
+  auto count = [&](const size_t start, const size_t end, const uint32_t shift,
+                   Histogram& histogram) {
+    histogram.fill(0);
+    for (auto ix = start; ix < end; ++ix) {
+      ++histogram[(codes(ix) >> shift) & 0xFFU];
+    }
+  };
 
-// Pointer to the bits extracting function.
-using deinterleaver_t = std::tuple<uint32_t, uint32_t> (*)(uint64_t);
+  for_each_chunk(
+      [&](const size_t start, const size_t end, Histogram& histogram) {
+        fill(start, end, codes.data() + start);
+        for (auto ix = start; ix < end; ++ix) {
+          index(ix) = static_cast<int64_t>(ix);
+        }
+        count(start, end, 0, histogram);
+      });
 
-// Can the CPU use the BIM2 instruction set?
-static const bool have_bim2 = detail::has_bmi2();
+  for (uint32_t shift = 0; shift < bits; shift += 8) {
+    if (shift != 0) {
+      for_each_chunk(
+          [&](const size_t start, const size_t end, Histogram& histogram) {
+            count(start, end, shift, histogram);
+          });
+    }
+    // Position of the first item of each digit written by each chunk. A pass
+    // where all the codes share the same digit is skipped.
+    auto offset = size_t(0);
+    auto skip = false;
+    for (size_t digit = 0; digit < 256; ++digit) {
+      auto total = size_t(0);
+      for (auto& item : histograms) {
+        const auto items = item[digit];
+        item[digit] = offset + total;
+        total += items;
+      }
+      skip |= total == size;
+      offset += total;
+    }
+    if (skip) {
+      continue;
+    }
+    for_each_chunk(
+        [&](const size_t start, const size_t end, Histogram& histogram) {
+          for (auto ix = start; ix < end; ++ix) {
+            const auto position = histogram[(codes(ix) >> shift) & 0xFFU]++;
+            codes_tmp(position) = codes(ix);
+            index_tmp(position) = index(ix);
+          }
+        });
+    codes.swap(codes_tmp);
+    index.swap(index_tmp);
+  }
+  return std::make_tuple(std::move(index), std::move(codes));
+}
 
-// Sets the encoding/decoding functions according to the CPU capacity
-static encoder_t encoder = have_bim2 ? detail::encode_bim2 : detail::encode;
-static deinterleaver_t deinterleaver =
-    have_bim2 ? detail::deinterleave_bim2 : detail::deinterleave;
+}  // namespace detail
 
 // ---------------------------------------------------------------------------
 auto encode(const Point& point, const uint32_t precision) -> uint64_t {
-  auto result = encoder(point.lat, point.lng);
-  if (precision != 64) {
-    result >>= (64 - precision);
+  return kernel::current().encode(point.lat, point.lng) >> (64 - precision);
+}
+
+// ---------------------------------------------------------------------------
+auto encode(const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
+            const uint32_t precision, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(points.size());
+  const auto& kernel = kernel::current();
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        kernel.encode_points(points.data() + start, end - start, precision,
+                             result.data() + start);
+      },
+      static_cast<size_t>(points.size()), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto encode(const Coordinates<T>& lng, const Coordinates<T>& lat,
+            const uint32_t precision, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  if (lng.size() != lat.size()) {
+    throw std::invalid_argument("lng and lat must have the same size");
   }
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(lng.size());
+  // The batch functions of the kernels only handle contiguous vectors.
+  const auto contiguous = lng.innerStride() == 1 && lat.innerStride() == 1;
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        if (contiguous) {
+          kernel::encode(lng.data() + start, lat.data() + start, end - start,
+                         precision, result.data() + start);
+          return;
+        }
+        for (auto ix = start; ix < end; ++ix) {
+          result(ix) = encode({static_cast<double>(lng(ix)),
+                               static_cast<double>(lat(ix))},
+                              precision);
+        }
+      },
+      static_cast<size_t>(lng.size()), num_threads);
   return result;
 }
 
+template auto encode<double>(const Coordinates<double>&,
+                             const Coordinates<double>&, uint32_t, size_t)
+    -> Eigen::Matrix<uint64_t, -1, 1>;
+template auto encode<float>(const Coordinates<float>&,
+                            const Coordinates<float>&, uint32_t, size_t)
+    -> Eigen::Matrix<uint64_t, -1, 1>;
+
 // ---------------------------------------------------------------------------
 auto bounding_box(const uint64_t hash, const uint32_t precision) -> Box {
-  auto full_hash = hash << (64U - precision);
-  auto lat_lng_int = deinterleaver(full_hash);
-  auto lat = detail::decode_range(std::get<0>(lat_lng_int), 90);
-  auto lng = detail::decode_range(std::get<1>(lat_lng_int), 180);
-  auto lng_lat_err = error_with_precision(precision);
+  const auto& decoder = kernel::decoder(precision);
+  auto lat_lng_int = kernel::current().deinterleave(hash << decoder.shift);
+  auto lat = kernel::decode_range(std::get<0>(lat_lng_int), 90);
+  auto lng = kernel::decode_range(std::get<1>(lat_lng_int), 180);
 
   return {
       {lng, lat},
-      {lng + std::get<0>(lng_lat_err), lat + std::get<1>(lng_lat_err)},
+      {lng + decoder.lng_err, lat + decoder.lat_err},
   };
 }
 
+// ---------------------------------------------------------------------------
+auto bounding_box(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+                  const uint32_t precision, MutableCoordinates<double> lng_min,
+                  MutableCoordinates<double> lat_min,
+                  MutableCoordinates<double> lng_max,
+                  MutableCoordinates<double> lat_max, const size_t num_threads)
+    -> void {
+  if (lng_min.size() != hashs.size() || lat_min.size() != hashs.size() ||
+      lng_max.size() != hashs.size() || lat_max.size() != hashs.size()) {
+    throw std::invalid_argument(
+        "lng_min, lat_min, lng_max, lat_max and hashs must have the same "
+        "size");
+  }
+  const auto& kernel = kernel::current();
+  const auto& decoder = kernel::decoder(precision);
+  // The batch functions of the kernels only handle contiguous vectors.
+  const auto contiguous =
+      lng_min.innerStride() == 1 && lat_min.innerStride() == 1 &&
+      lng_max.innerStride() == 1 && lat_max.innerStride() == 1;
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        if (contiguous) {
+          kernel.decode_boxes(hashs.data() + start, end - start, decoder,
+                              lng_min.data() + start, lat_min.data() + start,
+                              lng_max.data() + start, lat_max.data() + start);
+          return;
+        }
+        // The boxes are decoded by blocks, then scattered into the vectors.
+        auto buffer = std::array<std::array<double, 256>, 4>();
+        for (auto ix = start; ix < end; ix += buffer[0].size()) {
+          auto size = std::min(buffer[0].size(), end - ix);
+          kernel.decode_boxes(hashs.data() + ix, size, decoder,
+                              buffer[0].data(), buffer[1].data(),
+                              buffer[2].data(), buffer[3].data());
+          for (size_t jx = 0; jx < size; ++jx) {
+            lng_min(ix + jx) = buffer[0][jx];
+            lat_min(ix + jx) = buffer[1][jx];
+            lng_max(ix + jx) = buffer[2][jx];
+            lat_max(ix + jx) = buffer[3][jx];
+          }
+        }
+      },
+      static_cast<size_t>(hashs.size()), num_threads);
+}
+
+// ---------------------------------------------------------------------------
+auto decode(const uint64_t hash, const uint32_t precision, const bool round)
+    -> Point {
+  const auto& decoder = kernel::decoder(precision);
+  auto lat_lng_int = kernel::current().deinterleave(hash << decoder.shift);
+  return decoder.decode(std::get<0>(lat_lng_int), std::get<1>(lat_lng_int),
+                        round);
+}
+
+// ---------------------------------------------------------------------------
+auto decode(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+            const uint32_t precision, const bool round,
+            const size_t num_threads) -> Eigen::Matrix<Point, -1, 1> {
+  auto result = Eigen::Matrix<Point, -1, 1>(hashs.size());
+  const auto& kernel = kernel::current();
+  const auto& decoder = kernel::decoder(precision);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        kernel.decode_points(hashs.data() + start, end - start, decoder, round,
+                             result.data() + start);
+      },
+      static_cast<size_t>(hashs.size()), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto decode(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+            const uint32_t precision, const bool round,
+            MutableCoordinates<T> lng, MutableCoordinates<T> lat,
+            const size_t num_threads) -> void {
+  if (lng.size() != hashs.size() || lat.size() != hashs.size()) {
+    throw std::invalid_argument(
+        "lng, lat and hashs must have the same size");
+  }
+  const auto& kernel = kernel::current();
+  const auto& decoder = kernel::decoder(precision);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        // The points are decoded by blocks, then scattered into the vectors.
+        auto points = std::array<Point, 256>();
+        for (auto ix = start; ix < end; ix += points.size()) {
+          auto size = std::min(points.size(), end - ix);
+          kernel.decode_points(hashs.data() + ix, size, decoder, round,
+                               points.data());
+          for (size_t jx = 0; jx < size; ++jx) {
+            lng(ix + jx) = static_cast<T>(points[jx].lng);
+            lat(ix + jx) = static_cast<T>(points[jx].lat);
+          }
+        }
+      },
+      static_cast<size_t>(hashs.size()), num_threads);
+}
+
+template auto decode<double>(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>&, uint32_t, bool,
+    MutableCoordinates<double>, MutableCoordinates<double>, size_t) -> void;
+template auto decode<float>(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>&, uint32_t, bool,
+    MutableCoordinates<float>, MutableCoordinates<float>, size_t) -> void;
+
 // ---------------------------------------------------------------------------
 auto neighbors(const uint64_t hash, const uint32_t precision)
     -> Eigen::Matrix<uint64_t, 8, 1> {
-  double lat_delta;
-  double lng_delta;
-  auto box = bounding_box(hash, precision);
-  auto center = box.center();
-  std::tie(lng_delta, lat_delta) = box.delta(false);
+  const auto layout = detail::Layout(precision);
+  const auto lng = hash & layout.lng;
+  const auto lat = hash & layout.lat;
+
+  // The unit of a dilated integer is the lowest bit of its mask.
+  const auto lng_unit = layout.lng & -layout.lng;
+  const auto lat_unit = layout.lat & -layout.lat;
+  const auto east = detail::dilated_add(lng, lng_unit, layout.lng);
+  const auto west = detail::dilated_sub(lng, lng_unit, layout.lng);
+  const auto north =
+      lat == layout.lat ? lat : detail::dilated_add(lat, lat_unit, layout.lat);
+  const auto south =
+      lat == 0 ? lat : detail::dilated_sub(lat, lat_unit, layout.lat);
 
   return (Eigen::Matrix<uint64_t, 8, 1>() <<
               // N
-              encode({center.lng, center.lat + lat_delta}, precision),
-          // NE,
-          encode({center.lng + lng_delta, center.lat + lat_delta}, precision),
-          // E,
-          encode({center.lng + lng_delta, center.lat}, precision),
-          // SE,
-          encode({center.lng + lng_delta, center.lat - lat_delta}, precision),
-          // S,
-          encode({center.lng, center.lat - lat_delta}, precision),
-          // SW,
-          encode({center.lng - lng_delta, center.lat - lat_delta}, precision),
-          // W,
-          encode({center.lng - lng_delta, center.lat}, precision),
+              (lng | north),
+          // NE
+          (east | north),
+          // E
+          (east | lat),
+          // SE
+          (east | south),
+          // S
+          (lng | south),
+          // SW
+          (west | south),
+          // W
+          (west | lat),
           // NW
-          encode({center.lng - lng_delta, center.lat + lat_delta}, precision))
+          (west | north))
       .finished();
 }
 
+// ---------------------------------------------------------------------------
+auto neighbors(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+               const uint32_t precision, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 8, Eigen::RowMajor> {
+  auto result =
+      Eigen::Matrix<uint64_t, -1, 8, Eigen::RowMajor>(hashs.size(), 8);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          result.row(ix) = neighbors(hashs(ix), precision).transpose();
+        }
+      },
+      static_cast<size_t>(hashs.size()), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto k_ring(const uint64_t hash, const uint32_t precision, const uint32_t k)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  detail::check_k_ring(precision, k);
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(k_ring_size(k));
+  detail::k_ring(hash, k, detail::Layout(precision), result.data());
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto k_ring(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+            const uint32_t precision, const uint32_t k,
+            const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor> {
+  detail::check_k_ring(precision, k);
+  const auto layout = detail::Layout(precision);
+  const auto cols = k_ring_size(k);
+  auto result =
+      Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>(hashs.size(), cols);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          detail::k_ring(hashs(ix), k, layout, result.data() + ix * cols);
+        }
+      },
+      static_cast<size_t>(hashs.size()), num_threads,
+      std::max(parallel::kMinChunkSize / cols, size_t(1)));
+  return result;
+}
+
 // ---------------------------------------------------------------------------
 auto grid_properties(const Box& box, const uint32_t precision)
     -> std::tuple<uint64_t, size_t, size_t> {
@@ -242,92 +787,582 @@ auto grid_properties(const Box& box, const uint32_t precision)
 }
 
 // ---------------------------------------------------------------------------
-auto bounding_boxes(const std::optional<Box>& box, const uint32_t precision)
-    -> Eigen::Matrix<uint64_t, -1, 1> {
-  size_t lat_step;
-  size_t lng_step;
-  size_t size = 0;
-  uint64_t hash_sw;
+auto grid_walk(const uint64_t hash_sw, const uint32_t precision,
+               const size_t row, const size_t col, const size_t count,
+               uint64_t* codes) -> void {
+  const auto layout = detail::Layout(precision);
+  // The unit of a dilated integer is the lowest bit of its mask.
+  const auto lng_unit = layout.lng & -layout.lng;
+  auto code = detail::move(hash_sw, static_cast<int64_t>(col),
+                           static_cast<int64_t>(row), layout);
+  auto lat = code & layout.lat;
+  auto lng = code & layout.lng;
+  for (size_t ix = 0; ix < count; ++ix) {
+    codes[ix] = lng | lat;
+    lng = detail::dilated_add(lng, lng_unit, layout.lng);
+  }
+}
 
-  // Calculation of the number of elements constituting the grid
-  const auto boxes = box.value_or(Box({-180, -90}, {180, 90})).split();
-  for (const auto& item : boxes) {
-    std::tie(hash_sw, lng_step, lat_step) = grid_properties(item, precision);
-    size += lat_step * lng_step;
+// ---------------------------------------------------------------------------
+Grid::Grid(const std::optional<Box>& box, const uint32_t precision)
+    : precision_(precision) {
+  for (const auto& item : box.value_or(Box({-180, -90}, {180, 90})).split()) {
+    uint64_t hash_sw;
+    size_t cols;
+    size_t rows;
+    std::tie(hash_sw, cols, rows) = grid_properties(item, precision);
+    parts_.push_back({hash_sw, cols, rows, size_});
+    size_ += cols * rows;
   }
+}
 
-  // Grid resolution in degrees
-  const auto lng_lat_err = error_with_precision(precision);
+// ---------------------------------------------------------------------------
+auto Grid::walk(size_t index, size_t count, uint64_t* codes) const -> void {
+  auto it = parts_.begin();
+  while (count != 0) {
+    while (index >= it->offset + it->cols * it->rows) {
+      ++it;
+    }
+    auto local = index - it->offset;
+    auto col = local % it->cols;
+    auto size = std::min(count, it->cols - col);
+    grid_walk(it->hash_sw, precision_, local / it->cols, col, size, codes);
+    codes += size;
+    index += size;
+    count -= size;
+  }
+}
 
-  // Allocation of the vector storing the different codes of the matrix created
-  auto result = Eigen::Matrix<uint64_t, -1, 1>(size);
-  auto ix = size_t(0);
+// ---------------------------------------------------------------------------
+auto Grid::codes(const size_t start, const size_t count, uint64_t* codes,
+                 const size_t num_threads) const -> void {
+  if (start > size_ || count > size_ - start) {
+    throw std::out_of_range("the cells requested are outside the grid");
+  }
+  parallel::dispatch(
+      [&](const size_t first, const size_t last) {
+        walk(start + first, last - first, codes + first);
+      },
+      count, num_threads);
+}
 
-  for (const auto& item : boxes) {
-    std::tie(hash_sw, lng_step, lat_step) = grid_properties(item, precision);
-    auto point_sw = decode(hash_sw, precision, true);
+// ---------------------------------------------------------------------------
+Cover::Cover(const std::optional<Box>& box, const uint32_t precision,
+             const size_t chunk_size)
+    : grid_(box, precision), chunk_size_(chunk_size) {
+  if (chunk_size == 0) {
+    throw std::invalid_argument("chunk_size must be greater than 0");
+  }
+}
 
-    for (size_t lat = 0; lat < lat_step; ++lat) {
-      const auto lat_shift = lat * std::get<1>(lng_lat_err);
+// ---------------------------------------------------------------------------
+auto Cover::seek(const size_t cursor) -> void {
+  if (cursor > grid_.size()) {
+    throw std::out_of_range("cursor must be within [0, " +
+                            std::to_string(grid_.size()) + "]");
+  }
+  cursor_ = cursor;
+}
 
-      for (size_t lng = 0; lng < lng_step; ++lng) {
-        const auto lng_shift = lng * std::get<0>(lng_lat_err);
+// ---------------------------------------------------------------------------
+auto Cover::advance() -> std::tuple<size_t, size_t> {
+  auto start = cursor_;
+  cursor_ += std::min(chunk_size_, grid_.size() - cursor_);
+  return std::make_tuple(start, cursor_);
+}
 
-        result(ix++) = encode(
-            {point_sw.lng + lng_shift, point_sw.lat + lat_shift}, precision);
+// ---------------------------------------------------------------------------
+auto Cover::next(const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+  size_t start;
+  size_t end;
+  std::tie(start, end) = advance();
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(end - start);
+  grid_.codes(start, end - start, result.data(), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto bounding_boxes(const std::optional<Box>& box, const uint32_t precision,
+                    const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  const auto grid = Grid(box, precision);
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(grid.size());
+  grid.codes(0, grid.size(), result.data(), num_threads);
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto polygon_cover(const Polygon& polygon, const uint32_t precision,
+                   const size_t num_threads)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>> {
+  const auto coverer = detail::PolygonCoverer(polygon, precision);
+  std::vector<uint64_t> cells;
+  uint32_t level;
+  std::tie(cells, level) = coverer.top_level_cells();
+
+  // The cells found in each top-level cell.
+  auto inside = std::vector<std::vector<uint64_t>>(cells.size());
+  auto boundary = std::vector<std::vector<uint64_t>>(cells.size());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          auto on_inside = [&](const uint64_t hash, const uint32_t depth) {
+            const auto shift = precision - depth;
+            const auto first = hash << shift;
+            for (uint64_t jx = 0; jx < (uint64_t(1) << shift); ++jx) {
+              inside[ix].push_back(first + jx);
+            }
+          };
+          auto on_boundary = [&](const uint64_t hash) {
+            boundary[ix].push_back(hash);
+          };
+          coverer.refine(cells[ix], level, coverer.edges(), on_inside,
+                         on_boundary);
+        }
+      },
+      cells.size(), num_threads, 1);
+
+  // The descendants of the sorted top-level cells are sorted, so the cells
+  // are concatenated in order.
+  auto concatenate = [](const std::vector<std::vector<uint64_t>>& parts) {
+    auto size = size_t(0);
+    for (const auto& item : parts) {
+      size += item.size();
+    }
+    auto result = Eigen::Matrix<uint64_t, -1, 1>(size);
+    auto ptr = result.data();
+    for (const auto& item : parts) {
+      ptr = std::copy(item.begin(), item.end(), ptr);
+    }
+    return result;
+  };
+  return std::make_tuple(concatenate(inside), concatenate(boundary));
+}
+
+// ---------------------------------------------------------------------------
+auto bounding_boxes(const Polygon& polygon, const uint32_t precision,
+                    const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  Eigen::Matrix<uint64_t, -1, 1> inside;
+  Eigen::Matrix<uint64_t, -1, 1> boundary;
+  std::tie(inside, boundary) = polygon_cover(polygon, precision, num_threads);
+
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(inside.size() + boundary.size());
+  std::merge(inside.data(), inside.data() + inside.size(), boundary.data(),
+             boundary.data() + boundary.size(), result.data());
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto circle_cover(const Point& center, const double radius,
+                  const uint32_t precision, const size_t num_threads)
+    -> CircleCover {
+  // Number of cells from which the refinement is distributed among the
+  // threads.
+  constexpr size_t min_cells = 256;
+
+  if (!(radius >= 0)) {
+    throw std::invalid_argument("radius must be a positive number");
+  }
+  const auto distance = detail::CellDistance(center);
+  auto within = [&](const uint64_t hash, const uint32_t level) -> bool {
+    return std::get<0>(distance(bounding_box(hash, level))) <= radius;
+  };
+
+  // The cells within the radius are selected level by level until there are
+  // enough of them to be refined in parallel.
+  auto level = std::min(precision, 5U);
+  auto cells = std::vector<uint64_t>();
+  for (uint64_t ix = 0; ix < (uint64_t(1) << level); ++ix) {
+    if (within(ix, level)) {
+      cells.push_back(ix);
+    }
+  }
+  while (level < precision && cells.size() < min_cells) {
+    const auto bits = std::min(precision - level, 5U);
+    auto children = std::vector<uint64_t>();
+    for (const auto hash : cells) {
+      for (uint64_t ix = 0; ix < (uint64_t(1) << bits); ++ix) {
+        const auto child = (hash << bits) | ix;
+        if (within(child, level + bits)) {
+          children.push_back(child);
+        }
       }
     }
+    cells = std::move(children);
+    level += bits;
+  }
+
+  auto parts = std::vector<std::vector<detail::CircleCell>>(cells.size());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          detail::refine_circle(distance, radius, cells[ix], level, precision,
+                                parts[ix]);
+        }
+      },
+      cells.size(), num_threads, 1);
+
+  auto items = std::vector<detail::CircleCell>();
+  for (auto& item : parts) {
+    items.insert(items.end(), item.begin(), item.end());
+    item = std::vector<detail::CircleCell>();
+  }
+  std::sort(items.begin(), items.end());
+
+  auto result = std::make_tuple(
+      Eigen::Matrix<uint64_t, -1, 1>(items.size()),
+      Eigen::Matrix<double, -1, 1>(items.size()),
+      Eigen::Matrix<double, -1, 1>(items.size()));
+  for (size_t ix = 0; ix < items.size(); ++ix) {
+    std::get<0>(result)(ix) = std::get<2>(items[ix]);
+    std::get<1>(result)(ix) = std::get<0>(items[ix]);
+    std::get<2>(result)(ix) = std::get<1>(items[ix]);
   }
   return result;
 }
 
 // ---------------------------------------------------------------------------
-auto where(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, -1>>& hash)
-    -> std::map<uint64_t, std::tuple<std::tuple<int64_t, int64_t>,
-                                     std::tuple<int64_t, int64_t>>> {
-  // Index shifts of neighboring pixels
-  static const auto shift_row =
-      std::array<int64_t, 8>{-1, -1, -1, 0, 1, 0, 1, 1};
-  static const auto shift_col =
-      std::array<int64_t, 8>{-1, 1, 0, -1, -1, 1, 0, 1};
+auto compact(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint32_t, -1, 1>> {
+  if (hashs.size() != precisions.size()) {
+    throw std::invalid_argument(
+        "hashs and precisions must have the same size");
+  }
+  // A cell of the cover: its code aligned on the most significant bit, which
+  // gives the position of the cell along the Z-order curve, and its
+  // precision.
+  using Cell = std::tuple<uint64_t, uint32_t>;
 
-  auto result = std::map<uint64_t, std::tuple<std::tuple<int64_t, int64_t>,
-                                              std::tuple<int64_t, int64_t>>>();
+  auto cells = std::vector<Cell>();
+  cells.reserve(hashs.size());
+  for (auto ix = 0; ix < hashs.size(); ++ix) {
+    const auto precision = precisions(ix);
+    if (precision < 1 || precision > 64) {
+      throw std::invalid_argument("precision must be within [1, 64]");
+    }
+    cells.emplace_back(hashs(ix) << (64 - precision), precision);
+  }
+  // A cell precedes its descendants.
+  std::sort(cells.begin(), cells.end());
 
-  auto rows = hash.rows();
-  auto cols = hash.cols();
+  auto stack = std::vector<Cell>();
+  stack.reserve(cells.size());
+  auto last = uint64_t(0);
+  for (const auto& [key, precision] : cells) {
+    // Skips the cells contained in the previous one.
+    if (!stack.empty() && key <= last) {
+      continue;
+    }
+    last = precision == 64 ? key : key | (~uint64_t(0) >> precision);
 
-  for (int64_t ix = 0; ix < rows; ++ix) {
-    for (int64_t jx = 0; jx < cols; ++jx) {
-      const auto code = hash(ix, jx);
+    auto code = key >> (64 - precision);
+    auto level = precision;
+    // Merges the 32 children of a parent as soon as the last one is pushed.
+    // The children are contiguous at the top of the stack, because they are
+    // sorted and a child contained in a coarser cell has been skipped.
+    while (level > 5 && (code & 0x1FU) == 0x1FU && stack.size() >= 31 &&
+           std::all_of(stack.end() - 31, stack.end(), [&](const Cell& item) {
+             return std::get<1>(item) == level &&
+                    (std::get<0>(item) >> (64 - level + 5)) ==
+                        (code >> 5U);
+           })) {
+      stack.resize(stack.size() - 31);
+      code >>= 5U;
+      level -= 5;
+    }
+    stack.emplace_back(code << (64 - level), level);
+  }
 
-      // Hash already been processed?
-      auto it = result.find(code);
-      if (it == result.end()) {
-        result.emplace(std::make_pair(
-            code,
-            std::make_tuple(std::make_tuple(ix, ix), std::make_tuple(jx, jx))));
-        continue;
-      }
+  auto result = std::make_tuple(Eigen::Matrix<uint64_t, -1, 1>(stack.size()),
+                                Eigen::Matrix<uint32_t, -1, 1>(stack.size()));
+  for (size_t ix = 0; ix < stack.size(); ++ix) {
+    const auto& [key, precision] = stack[ix];
+    std::get<0>(result)(ix) = key >> (64 - precision);
+    std::get<1>(result)(ix) = precision;
+  }
+  return result;
+}
 
-      for (int64_t kx = 0; kx < 8; ++kx) {
-        const auto i = ix + shift_row[kx];
-        const auto j = jx + shift_col[kx];
+// ---------------------------------------------------------------------------
+auto expand(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+            const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions,
+            const uint32_t precision, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  if (hashs.size() != precisions.size()) {
+    throw std::invalid_argument(
+        "hashs and precisions must have the same size");
+  }
+  // Position of the first descendant of each cell in the result.
+  auto offsets = std::vector<size_t>(hashs.size() + 1, 0);
+  for (auto ix = 0; ix < hashs.size(); ++ix) {
+    if (precisions(ix) < 1 || precisions(ix) > precision) {
+      throw std::invalid_argument("precision must be within [1, " +
+                                  std::to_string(precision) + "]");
+    }
+    const auto bits = precision - precisions(ix);
+    if (bits >= 48) {
+      throw std::invalid_argument("too many cells to expand");
+    }
+    offsets[ix + 1] = offsets[ix] + (size_t(1) << bits);
+  }
 
-        // Does the adjacent pixel belong to the same GeoHash?
-        if (i >= 0 && i < rows && j >= 0 && j < cols && code == hash(i, j)) {
-          auto& first = std::get<0>(it->second);
-          std::get<0>(first) = std::min(std::get<0>(first), i);
-          std::get<1>(first) = std::max(std::get<1>(first), i);
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(offsets.back());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          const auto first = hashs(ix) << (precision - precisions(ix));
+          auto ptr = result.data() + offsets[ix];
+          for (auto jx = uint64_t(0); jx < offsets[ix + 1] - offsets[ix];
+               ++jx) {
+            *(ptr++) = first + jx;
+          }
+        }
+      },
+      static_cast<size_t>(hashs.size()), num_threads, 1);
+  return result;
+}
 
-          auto& second = std::get<1>(it->second);
-          std::get<0>(second) = std::min(std::get<0>(second), j);
-          std::get<1>(second) = std::max(std::get<1>(second), j);
+// ---------------------------------------------------------------------------
+auto range_cover(const std::optional<Box>& box, const uint32_t precision,
+                 const size_t max_ranges)
+    -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor> {
+  const auto layout = detail::Layout(precision);
+  auto ranges = detail::Ranges();
+  for (const auto& item : box.value_or(Box({-180, -90}, {180, 90})).split()) {
+    uint64_t hash_sw;
+    size_t cols;
+    size_t rows;
+    std::tie(hash_sw, cols, rows) = grid_properties(item, precision);
+    const auto x0 = kernel::squash((hash_sw & layout.lng) >> layout.lng_shift);
+    const auto y0 = kernel::squash((hash_sw & layout.lat) >> layout.lat_shift);
+    auto part = detail::Ranges();
+    detail::rectangle_ranges(
+        0, precision,
+        {x0, static_cast<uint32_t>(x0 + cols - 1), y0,
+         static_cast<uint32_t>(y0 + rows - 1)},
+        layout, part);
+    // The parts on both sides of the antimeridian are disjoint.
+    auto middle = ranges.size();
+    ranges.insert(ranges.end(), part.begin(), part.end());
+    std::inplace_merge(ranges.begin(), ranges.begin() + middle, ranges.end());
+  }
+  auto merged = detail::Ranges();
+  for (const auto& item : ranges) {
+    detail::append_range(merged, item[0], item[1]);
+  }
+  return detail::limit_ranges(merged, max_ranges);
+}
+
+// ---------------------------------------------------------------------------
+auto range_cover(const Polygon& polygon, const uint32_t precision,
+                 const size_t max_ranges, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor> {
+  const auto coverer = detail::PolygonCoverer(polygon, precision);
+  std::vector<uint64_t> cells;
+  uint32_t level;
+  std::tie(cells, level) = coverer.top_level_cells();
+
+  // The intervals found in each top-level cell. A cell within the polygon
+  // gives an interval without being refined.
+  auto ranges = std::vector<detail::Ranges>(cells.size());
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          auto on_inside = [&](const uint64_t hash, const uint32_t depth) {
+            const auto shift = precision - depth;
+            detail::append_range(ranges[ix], hash << shift,
+                                 (hash + 1) << shift);
+          };
+          auto on_boundary = [&](const uint64_t hash) {
+            detail::append_range(ranges[ix], hash, hash + 1);
+          };
+          coverer.refine(cells[ix], level, coverer.edges(), on_inside,
+                         on_boundary);
         }
-      }
+      },
+      cells.size(), num_threads, 1);
+
+  auto merged = detail::Ranges();
+  for (const auto& part : ranges) {
+    for (const auto& item : part) {
+      detail::append_range(merged, item[0], item[1]);
+    }
+  }
+  return detail::limit_ranges(merged, max_ranges);
+}
+
+// ---------------------------------------------------------------------------
+auto where(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>>&
+        hashs,
+    const size_t num_threads) -> Extents {
+  // Code of a grid and the extent of its pixels.
+  struct Item {
+    uint64_t code;
+    std::array<int64_t, 4> extent;
+  };
+
+  const auto rows = static_cast<size_t>(hashs.rows());
+  const auto cols = static_cast<int64_t>(hashs.cols());
+  const auto bands =
+      rows == 0 ? size_t(1)
+                : parallel::num_workers(rows * cols, num_threads);
+  const auto band_rows = (rows + bands - 1) / bands;
+
+  // Codes found in each band of rows, in order of appearance.
+  auto partials = std::vector<std::vector<Item>>(bands);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto band = start; band < end; ++band) {
+          auto& items = partials[band];
+          auto index = std::unordered_map<uint64_t, size_t>();
+          const auto last_row = std::min((band + 1) * band_rows, rows);
+          // Neighboring pixels often share the same code, so the item of the
+          // previous pixel is looked up first.
+          auto current = std::numeric_limits<size_t>::max();
+          for (auto ix = static_cast<int64_t>(band * band_rows);
+               ix < static_cast<int64_t>(last_row); ++ix) {
+            const auto* row = hashs.row(ix).data();
+            for (int64_t jx = 0; jx < cols; ++jx) {
+              const auto code = row[jx];
+              if (current == std::numeric_limits<size_t>::max() ||
+                  items[current].code != code) {
+                auto [it, inserted] = index.try_emplace(code, items.size());
+                if (inserted) {
+                  items.push_back({code, {ix, ix, jx, jx}});
+                }
+                current = it->second;
+              }
+              // The rows are scanned in ascending order.
+              auto& extent = items[current].extent;
+              extent[1] = ix;
+              extent[2] = std::min(extent[2], jx);
+              extent[3] = std::max(extent[3], jx);
+            }
+          }
+        }
+      },
+      bands, num_threads, 1);
+
+  // Merges the extents of the codes found in several bands.
+  auto items = std::vector<Item>();
+  for (auto& item : partials) {
+    items.insert(items.end(), item.begin(), item.end());
+    item = std::vector<Item>();
+  }
+  std::sort(items.begin(), items.end(),
+            [](const Item& lhs, const Item& rhs) { return lhs.code < rhs.code; });
+  auto size = size_t(0);
+  for (size_t ix = 0; ix < items.size(); ++ix) {
+    if (size != 0 && items[size - 1].code == items[ix].code) {
+      auto& extent = items[size - 1].extent;
+      extent[0] = std::min(extent[0], items[ix].extent[0]);
+      extent[1] = std::max(extent[1], items[ix].extent[1]);
+      extent[2] = std::min(extent[2], items[ix].extent[2]);
+      extent[3] = std::max(extent[3], items[ix].extent[3]);
+    } else {
+      items[size++] = items[ix];
     }
   }
+
+  auto result = Extents(
+      Eigen::Matrix<uint64_t, -1, 1>(size), Eigen::Matrix<int64_t, -1, 1>(size),
+      Eigen::Matrix<int64_t, -1, 1>(size), Eigen::Matrix<int64_t, -1, 1>(size),
+      Eigen::Matrix<int64_t, -1, 1>(size));
+  for (size_t ix = 0; ix < size; ++ix) {
+    std::get<0>(result)(ix) = items[ix].code;
+    std::get<1>(result)(ix) = items[ix].extent[0];
+    std::get<2>(result)(ix) = items[ix].extent[1];
+    std::get<3>(result)(ix) = items[ix].extent[2];
+    std::get<4>(result)(ix) = items[ix].extent[3];
+  }
   return result;
 }
 
+// ---------------------------------------------------------------------------
+auto argsort(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const size_t num_threads)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>> {
+  return detail::radix_argsort(
+      static_cast<size_t>(hashs.size()), precision, num_threads,
+      [&](const size_t start, const size_t end, uint64_t* codes) {
+        for (auto ix = start; ix < end; ++ix) {
+          *(codes++) = hashs(ix);
+        }
+      });
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto argsort(const Coordinates<T>& lng, const Coordinates<T>& lat,
+             const uint32_t precision, const size_t num_threads)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>> {
+  if (lng.size() != lat.size()) {
+    throw std::invalid_argument("lng and lat must have the same size");
+  }
+  const auto contiguous = lng.innerStride() == 1 && lat.innerStride() == 1;
+  return detail::radix_argsort(
+      static_cast<size_t>(lng.size()), precision, num_threads,
+      [&](const size_t start, const size_t end, uint64_t* codes) {
+        if (contiguous) {
+          kernel::encode(lng.data() + start, lat.data() + start, end - start,
+                         precision, codes);
+          return;
+        }
+        for (auto ix = start; ix < end; ++ix) {
+          *(codes++) = encode({static_cast<double>(lng(ix)),
+                               static_cast<double>(lat(ix))},
+                              precision);
+        }
+      });
+}
+
+template auto argsort<double>(const Coordinates<double>&,
+                              const Coordinates<double>&, uint32_t, size_t)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>>;
+template auto argsort<float>(const Coordinates<float>&,
+                             const Coordinates<float>&, uint32_t, size_t)
+    -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<uint64_t, -1, 1>>;
+
+// ---------------------------------------------------------------------------
+auto permute(char* data, const size_t size, const size_t item_size,
+             const int64_t stride,
+             const Eigen::Ref<const Eigen::Matrix<int64_t, -1, 1>>& permutation,
+             const size_t num_threads) -> void {
+  if (static_cast<size_t>(permutation.size()) != size) {
+    throw std::invalid_argument(
+        "permutation and values must have the same size");
+  }
+  // The items are gathered in a contiguous buffer, then copied back.
+  auto buffer = std::vector<char>(size * item_size);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          const auto jx = permutation(ix);
+          if (jx < 0 || static_cast<size_t>(jx) >= size) {
+            throw std::out_of_range("permutation index out of range");
+          }
+          std::memcpy(buffer.data() + ix * item_size, data + jx * stride,
+                      item_size);
+        }
+      },
+      size, num_threads);
+  parallel::dispatch(
+      [&](const size_t start, const size_t end) {
+        for (auto ix = start; ix < end; ++ix) {
+          std::memcpy(data + static_cast<int64_t>(ix) * stride,
+                      buffer.data() + ix * item_size, item_size);
+        }
+      },
+      size, num_threads);
+}
+
 }  // namespace geohash::int64
\ No newline at end of file
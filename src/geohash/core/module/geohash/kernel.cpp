@@ -0,0 +1,510 @@
+#include "geohash/kernel.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "geohash/base32.hpp"
+#include "geohash/cpu.hpp"
+#include "geohash/simd.hpp"
+
+#ifdef GEOHASH_X86_64
+#include <immintrin.h>
+#endif
+
+// Ref: https://mmcloughlin.com/posts/geohash-assembly
+namespace geohash::kernel {
+
+static constexpr auto lat_scale = 0.005555555555555556;  // 1 / 180
+static constexpr auto lng_scale = 0.002777777777777778;  // 1 / 360
+
+// Kernel spreading and squashing the bits with shifts and masks.
+struct Scalar {
+  static auto encode(const double lat, const double lng) -> uint64_t {
+    return spread(quantize(lat, 90, lat_scale)) |
+           (spread(quantize(lng, 180, lng_scale)) << 1U);
+  }
+
+  static auto deinterleave(const uint64_t hash)
+      -> std::tuple<uint32_t, uint32_t> {
+    return std::make_tuple(squash(hash), squash(hash >> 1U));
+  }
+};
+
+// Returns the table spreading the 8 bits of a byte into 16 bits.
+static constexpr auto make_spread_table() -> std::array<uint16_t, 256> {
+  auto result = std::array<uint16_t, 256>{};
+  for (uint32_t ix = 0; ix < 256; ++ix) {
+    result[ix] = static_cast<uint16_t>(spread(ix));
+  }
+  return result;
+}
+
+// Returns the table squashing the even and odd bits of a byte into the low
+// and high nibbles of a byte.
+static constexpr auto make_squash_table() -> std::array<uint8_t, 256> {
+  auto result = std::array<uint8_t, 256>{};
+  for (uint32_t ix = 0; ix < 256; ++ix) {
+    result[ix] = static_cast<uint8_t>(squash(ix) | (squash(ix >> 1U) << 4U));
+  }
+  return result;
+}
+
+// Kernel spreading and squashing the bits one byte at a time with lookup
+// tables.
+struct Lut {
+  static constexpr auto spread_table = make_spread_table();
+  static constexpr auto squash_table = make_squash_table();
+
+  static auto spread(const uint32_t x) -> uint64_t {
+    return static_cast<uint64_t>(spread_table[x & 0xFFU]) |
+           (static_cast<uint64_t>(spread_table[(x >> 8U) & 0xFFU]) << 16U) |
+           (static_cast<uint64_t>(spread_table[(x >> 16U) & 0xFFU]) << 32U) |
+           (static_cast<uint64_t>(spread_table[x >> 24U]) << 48U);
+  }
+
+  static auto encode(const double lat, const double lng) -> uint64_t {
+    return spread(quantize(lat, 90, lat_scale)) |
+           (spread(quantize(lng, 180, lng_scale)) << 1U);
+  }
+
+  static auto deinterleave(const uint64_t hash)
+      -> std::tuple<uint32_t, uint32_t> {
+    auto lat = uint32_t(0);
+    auto lng = uint32_t(0);
+    for (uint32_t ix = 0; ix < 8; ++ix) {
+      auto nibbles = squash_table[(hash >> (ix * 8U)) & 0xFFU];
+      lat |= static_cast<uint32_t>(nibbles & 0xFU) << (ix * 4U);
+      lng |= static_cast<uint32_t>(nibbles >> 4U) << (ix * 4U);
+    }
+    return std::make_tuple(lat, lng);
+  }
+};
+
+#ifdef GEOHASH_X86_64
+// Kernel using the PDEP/PEXT instructions of the BMI2 instruction set. These
+// instructions are microcoded, and slow, on some AMD processors.
+struct Bmi2 {
+  GEOHASH_TARGET("bmi2")
+  static auto encode(const double lat, const double lng) -> uint64_t {
+    return _pdep_u64(quantize(lat, 90, lat_scale), 0x5555555555555555) |
+           _pdep_u64(quantize(lng, 180, lng_scale), 0XAAAAAAAAAAAAAAAA);
+  }
+
+  GEOHASH_TARGET("bmi2")
+  static auto deinterleave(const uint64_t hash)
+      -> std::tuple<uint32_t, uint32_t> {
+    return std::make_tuple(
+        static_cast<uint32_t>(_pext_u64(hash, 0x5555555555555555)),
+        static_cast<uint32_t>(_pext_u64(hash, 0XAAAAAAAAAAAAAAAA)));
+  }
+};
+#endif
+
+// Encode points into geohash with the scalar function of the kernel.
+template <typename Impl>
+inline auto encode_points(const Point* points, const size_t size,
+                          const uint32_t precision, uint64_t* hashs) -> void {
+  const auto shift = 64 - precision;
+  for (size_t ix = 0; ix < size; ++ix) {
+    hashs[ix] = Impl::encode(points[ix].lat, points[ix].lng) >> shift;
+  }
+}
+
+// Encode the positions given as separate arrays with the scalar function of
+// the kernel.
+template <typename Impl, typename T>
+inline auto encode_lnglat(const T* lng, const T* lat, const size_t size,
+                          const uint32_t precision, uint64_t* hashs) -> void {
+  const auto shift = 64 - precision;
+  for (size_t ix = 0; ix < size; ++ix) {
+    hashs[ix] = Impl::encode(static_cast<double>(lat[ix]),
+                             static_cast<double>(lng[ix])) >>
+                shift;
+  }
+}
+
+// Decode hashs into points with the scalar function of the kernel.
+template <typename Impl>
+inline auto decode_points(const uint64_t* hashs, const size_t size,
+                          const Decoder& decoder, const bool round,
+                          Point* points) -> void {
+  for (size_t ix = 0; ix < size; ++ix) {
+    auto lat_lng = Impl::deinterleave(hashs[ix] << decoder.shift);
+    points[ix] =
+        decoder.decode(std::get<0>(lat_lng), std::get<1>(lat_lng), round);
+  }
+}
+
+// Decode the regions encoded by the hashs with the scalar function of the
+// kernel.
+template <typename Impl>
+inline auto decode_boxes(const uint64_t* hashs, const size_t size,
+                         const Decoder& decoder, double* lng_min,
+                         double* lat_min, double* lng_max, double* lat_max)
+    -> void {
+  for (size_t ix = 0; ix < size; ++ix) {
+    auto lat_lng = Impl::deinterleave(hashs[ix] << decoder.shift);
+    auto lng = decode_range(std::get<1>(lat_lng), 180);
+    auto lat = decode_range(std::get<0>(lat_lng), 90);
+    lng_min[ix] = lng;
+    lat_min[ix] = lat;
+    lng_max[ix] = lng + decoder.lng_err;
+    lat_max[ix] = lat + decoder.lat_err;
+  }
+}
+
+// Base32 encoding used by the scalar functions.
+static const auto base32 = Base32();
+
+// Encode hashs into base32 one character at a time.
+static auto encode_base32(const uint64_t* hashs, const size_t size,
+                          const uint32_t chars, const size_t stride,
+                          char* buffer) -> void {
+  for (size_t ix = 0; ix < size; ++ix) {
+    Base32::encode(hashs[ix], buffer + ix * stride, chars);
+  }
+}
+
+// Decode base32 strings with a table lookup per character.
+static auto decode_base32(const char* buffer, const size_t size,
+                          const size_t stride, uint64_t* hashs,
+                          uint32_t* chars) -> size_t {
+  for (size_t ix = 0; ix < size; ++ix) {
+    const auto* hash = buffer + ix * stride;
+    if (!base32.validate(hash, stride)) {
+      return ix;
+    }
+    std::tie(hashs[ix], chars[ix]) = base32.decode(hash, stride);
+  }
+  return size;
+}
+
+// Test whether the points are within the box, one point at a time.
+static auto box_contains_points(const Point* points, const size_t size,
+                                const Box& box, bool* mask) -> void {
+  for (size_t ix = 0; ix < size; ++ix) {
+    mask[ix] = box.contains(points[ix]);
+  }
+}
+
+static auto box_contains_lnglat(const double* lng, const double* lat,
+                                const size_t size, const Box& box,
+                                bool* mask) -> void {
+  for (size_t ix = 0; ix < size; ++ix) {
+    mask[ix] = box.contains({lng[ix], lat[ix]});
+  }
+}
+
+#ifdef GEOHASH_X86_64
+// The BMI2 functions must be inlined in functions compiled for this
+// instruction set.
+GEOHASH_TARGET("bmi2")
+GEOHASH_FLATTEN
+static auto encode_points_bmi2(const Point* points, const size_t size,
+                               const uint32_t precision, uint64_t* hashs)
+    -> void {
+  encode_points<Bmi2>(points, size, precision, hashs);
+}
+
+GEOHASH_TARGET("bmi2")
+GEOHASH_FLATTEN
+static auto encode_lnglat_bmi2(const double* lng, const double* lat,
+                               const size_t size, const uint32_t precision,
+                               uint64_t* hashs) -> void {
+  encode_lnglat<Bmi2>(lng, lat, size, precision, hashs);
+}
+
+GEOHASH_TARGET("bmi2")
+GEOHASH_FLATTEN
+static auto encode_lnglat_bmi2(const float* lng, const float* lat,
+                               const size_t size, const uint32_t precision,
+                               uint64_t* hashs) -> void {
+  encode_lnglat<Bmi2>(lng, lat, size, precision, hashs);
+}
+
+GEOHASH_TARGET("bmi2")
+GEOHASH_FLATTEN
+static auto decode_points_bmi2(const uint64_t* hashs, const size_t size,
+                               const Decoder& decoder, const bool round,
+                               Point* points) -> void {
+  decode_points<Bmi2>(hashs, size, decoder, round, points);
+}
+
+GEOHASH_TARGET("bmi2")
+GEOHASH_FLATTEN
+static auto decode_boxes_bmi2(const uint64_t* hashs, const size_t size,
+                              const Decoder& decoder, double* lng_min,
+                              double* lat_min, double* lng_max,
+                              double* lat_max) -> void {
+  decode_boxes<Bmi2>(hashs, size, decoder, lng_min, lat_min, lng_max,
+                     lat_max);
+}
+#endif
+
+// Encode points with a vector kernel, the remaining items being processed by
+// the scalar kernel.
+template <size_t (*Vector)(const Point*, size_t, uint32_t, uint64_t*)>
+static auto encode_points_simd(const Point* points, const size_t size,
+                               const uint32_t precision, uint64_t* hashs)
+    -> void {
+  auto count = Vector(points, size, precision, hashs);
+  encode_points<Scalar>(points + count, size - count, precision,
+                        hashs + count);
+}
+
+// Encode the positions given as separate arrays with a vector kernel, the
+// remaining items being processed by the scalar kernel.
+template <typename T,
+          size_t (*Vector)(const T*, const T*, size_t, uint32_t, uint64_t*)>
+static auto encode_lnglat_simd(const T* lng, const T* lat, const size_t size,
+                               const uint32_t precision, uint64_t* hashs)
+    -> void {
+  auto count = Vector(lng, lat, size, precision, hashs);
+  encode_lnglat<Scalar>(lng + count, lat + count, size - count, precision,
+                        hashs + count);
+}
+
+// Decode hashs with a vector kernel, the remaining items being processed by
+// the scalar kernel.
+template <size_t (*Vector)(const uint64_t*, size_t, const Decoder&, bool,
+                           Point*)>
+static auto decode_points_simd(const uint64_t* hashs, const size_t size,
+                               const Decoder& decoder, const bool round,
+                               Point* points) -> void {
+  auto count = Vector(hashs, size, decoder, round, points);
+  decode_points<Scalar>(hashs + count, size - count, decoder, round,
+                        points + count);
+}
+
+// Decode the regions encoded by the hashs with a vector kernel, the remaining
+// items being processed by the scalar kernel.
+template <size_t (*Vector)(const uint64_t*, size_t, const Decoder&, double*,
+                           double*, double*, double*)>
+static auto decode_boxes_simd(const uint64_t* hashs, const size_t size,
+                              const Decoder& decoder, double* lng_min,
+                              double* lat_min, double* lng_max,
+                              double* lat_max) -> void {
+  auto count =
+      Vector(hashs, size, decoder, lng_min, lat_min, lng_max, lat_max);
+  decode_boxes<Scalar>(hashs + count, size - count, decoder, lng_min + count,
+                       lat_min + count, lng_max + count, lat_max + count);
+}
+
+// Encode hashs into base32 with a vector kernel, the remaining items being
+// processed by the scalar function.
+template <size_t (*Vector)(const uint64_t*, size_t, uint32_t, size_t, char*)>
+static auto encode_base32_simd(const uint64_t* hashs, const size_t size,
+                               const uint32_t chars, const size_t stride,
+                               char* buffer) -> void {
+  auto count = Vector(hashs, size, chars, stride, buffer);
+  encode_base32(hashs + count, size - count, chars, stride,
+                buffer + count * stride);
+}
+
+// Decode base32 strings with a vector kernel. The scalar function resumes
+// from the first string not decoded, and finds the invalid one, if any.
+template <size_t (*Vector)(const char*, size_t, size_t, uint64_t*, uint32_t*)>
+static auto decode_base32_simd(const char* buffer, const size_t size,
+                               const size_t stride, uint64_t* hashs,
+                               uint32_t* chars) -> size_t {
+  auto count = Vector(buffer, size, stride, hashs, chars);
+  return count + decode_base32(buffer + count * stride, size - count, stride,
+                               hashs + count, chars + count);
+}
+
+// Test whether the points are within the box with a vector kernel, the
+// remaining items being processed by the scalar function.
+template <size_t (*Vector)(const Point*, size_t, const Box&, bool*)>
+static auto box_contains_points_simd(const Point* points, const size_t size,
+                                     const Box& box, bool* mask) -> void {
+  auto count = Vector(points, size, box, mask);
+  box_contains_points(points + count, size - count, box, mask + count);
+}
+
+template <size_t (*Vector)(const double*, const double*, size_t, const Box&,
+                           bool*)>
+static auto box_contains_lnglat_simd(const double* lng, const double* lat,
+                                     const size_t size, const Box& box,
+                                     bool* mask) -> void {
+  auto count = Vector(lng, lat, size, box, mask);
+  box_contains_lnglat(lng + count, lat + count, size - count, box,
+                      mask + count);
+}
+
+// Kernels compiled, from the most portable to the most specific.
+static const auto scalar = Kernel{"scalar",
+                                  Scalar::encode,
+                                  Scalar::deinterleave,
+                                  encode_points<Scalar>,
+                                  encode_lnglat<Scalar, double>,
+                                  encode_lnglat<Scalar, float>,
+                                  decode_points<Scalar>,
+                                  decode_boxes<Scalar>,
+                                  encode_base32,
+                                  decode_base32,
+                                  box_contains_points,
+                                  box_contains_lnglat};
+
+static const auto lut = Kernel{"lut",
+                               Lut::encode,
+                               Lut::deinterleave,
+                               encode_points<Lut>,
+                               encode_lnglat<Lut, double>,
+                               encode_lnglat<Lut, float>,
+                               decode_points<Lut>,
+                               decode_boxes<Lut>,
+                               encode_base32,
+                               decode_base32,
+                               box_contains_points,
+                               box_contains_lnglat};
+
+#ifdef GEOHASH_X86_64
+static const auto bmi2 = Kernel{"bmi2",
+                                Bmi2::encode,
+                                Bmi2::deinterleave,
+                                encode_points_bmi2,
+                                encode_lnglat_bmi2,
+                                encode_lnglat_bmi2,
+                                decode_points_bmi2,
+                                decode_boxes_bmi2,
+                                encode_base32,
+                                decode_base32,
+                                box_contains_points,
+                                box_contains_lnglat};
+
+static const auto avx2 = Kernel{
+    "avx2",
+    Scalar::encode,
+    Scalar::deinterleave,
+    encode_points_simd<simd::encode_avx2>,
+    encode_lnglat_simd<double, simd::encode_avx2>,
+    encode_lnglat_simd<float, simd::encode_avx2>,
+    decode_points_simd<simd::decode_avx2>,
+    decode_boxes_simd<simd::decode_boxes_avx2>,
+    encode_base32_simd<simd::encode_base32_avx2>,
+    decode_base32_simd<simd::decode_base32_avx2>,
+    box_contains_points_simd<simd::box_contains_avx2>,
+    box_contains_lnglat_simd<simd::box_contains_avx2>};
+
+static const auto avx512 = Kernel{
+    "avx512",
+    Scalar::encode,
+    Scalar::deinterleave,
+    encode_points_simd<simd::encode_avx512>,
+    encode_lnglat_simd<double, simd::encode_avx512>,
+    encode_lnglat_simd<float, simd::encode_avx512>,
+    decode_points_simd<simd::decode_avx512>,
+    decode_boxes_simd<simd::decode_boxes_avx512>,
+    encode_base32_simd<simd::encode_base32_avx2>,
+    decode_base32_simd<simd::decode_base32_avx2>,
+    box_contains_points_simd<simd::box_contains_avx2>,
+    box_contains_lnglat_simd<simd::box_contains_avx2>};
+#endif
+
+// ---------------------------------------------------------------------------
+auto decoder(const uint32_t precision) -> const Decoder& {
+  static const auto table = []() -> std::array<Decoder, 64> {
+    auto result = std::array<Decoder, 64>();
+    for (uint32_t ix = 0; ix < 64; ++ix) {
+      auto lat_bits = static_cast<int32_t>((ix + 1) >> 1U);
+      auto lng_bits = static_cast<int32_t>(ix + 1) - lat_bits;
+      auto lng_err = 360 * power2(-lng_bits);
+      auto lat_err = 180 * power2(-lat_bits);
+      // Same computation as Box::round for the cells of this precision.
+      auto rounding = Box({0, 0}, {lng_err, lat_err}).delta(true);
+      result[ix] = {63 - ix, lng_err, lat_err, std::get<0>(rounding),
+                    std::get<1>(rounding)};
+    }
+    return result;
+  }();
+  return table[precision - 1];
+}
+
+// ---------------------------------------------------------------------------
+auto available() -> std::vector<const Kernel*> {
+  auto result = std::vector<const Kernel*>{&scalar, &lut};
+#ifdef GEOHASH_X86_64
+  if (cpu::has_bmi2()) {
+    result.push_back(&bmi2);
+  }
+  if (cpu::has_avx2()) {
+    result.push_back(&avx2);
+  }
+  if (cpu::has_avx512f()) {
+    result.push_back(&avx512);
+  }
+#endif
+  return result;
+}
+
+// Returns the time, in nanoseconds, taken by the kernel to encode and decode
+// a sample of points. The best time of several runs is retained.
+static auto benchmark(const Kernel& kernel) -> int64_t {
+  constexpr size_t size = 1024;
+  auto points = std::vector<Point>(size);
+  auto hashs = std::vector<uint64_t>(size);
+  auto decoded = std::vector<Point>(size);
+  for (size_t ix = 0; ix < size; ++ix) {
+    points[ix] = {-180 + 360.0 * static_cast<double>(ix * 409 % size) / size,
+                  -90 + 180.0 * static_cast<double>(ix) / size};
+  }
+
+  auto result = std::numeric_limits<int64_t>::max();
+  for (auto run = 0; run < 8; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    kernel.encode_points(points.data(), size, 64, hashs.data());
+    kernel.decode_points(hashs.data(), size, decoder(64), false,
+                         decoded.data());
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+    result = std::min(result, static_cast<int64_t>(elapsed));
+  }
+  return result;
+}
+
+// Returns the kernel named by the environment variable GEOHASH_KERNEL if it
+// is supported, otherwise the fastest kernel.
+static auto initialize() -> const Kernel* {
+  auto kernels = available();
+  if (const auto* name = std::getenv("GEOHASH_KERNEL")) {
+    for (const auto* item : kernels) {
+      if (item->name == std::string(name)) {
+        return item;
+      }
+    }
+  }
+  const Kernel* result = nullptr;
+  auto best = std::numeric_limits<int64_t>::max();
+  for (const auto* item : kernels) {
+    auto elapsed = benchmark(*item);
+    if (elapsed < best) {
+      best = elapsed;
+      result = item;
+    }
+  }
+  return result;
+}
+
+// Kernel in use
+static std::atomic<const Kernel*> current_{initialize()};
+
+// ---------------------------------------------------------------------------
+auto current() noexcept -> const Kernel& { return *current_.load(); }
+
+// ---------------------------------------------------------------------------
+auto select(const std::string& name) -> void {
+  for (const auto* item : available()) {
+    if (item->name == name) {
+      current_.store(item);
+      return;
+    }
+  }
+  throw std::invalid_argument("kernel '" + name +
+                              "' is unknown or not supported by the CPU");
+}
+
+}  // namespace geohash::kernel
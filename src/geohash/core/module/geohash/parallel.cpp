@@ -0,0 +1,24 @@
+#include "geohash/parallel.hpp"
+
+#include <atomic>
+
+namespace geohash::parallel {
+
+// Returns the number of concurrent threads supported by the CPU.
+static auto hardware_concurrency() noexcept -> size_t {
+  return std::max(static_cast<size_t>(std::thread::hardware_concurrency()),
+                  size_t(1));
+}
+
+// Default number of threads
+static std::atomic<size_t> num_threads_{hardware_concurrency()};
+
+// ---------------------------------------------------------------------------
+auto get_num_threads() noexcept -> size_t { return num_threads_.load(); }
+
+// ---------------------------------------------------------------------------
+auto set_num_threads(const size_t num_threads) noexcept -> void {
+  num_threads_.store(num_threads == 0 ? hardware_concurrency() : num_threads);
+}
+
+}  // namespace geohash::parallel
@@ -0,0 +1,759 @@
+#include "geohash/simd.hpp"
+
+#include "geohash/cpu.hpp"
+
+#include <cstring>
+
+#ifdef GEOHASH_X86_64
+#include <immintrin.h>
+#ifdef _WIN32
+#include <intrin.h>
+#endif
+#endif
+
+// The kernels reproduce, lane by lane, the arithmetic of the scalar encoders
+// (see kernel::quantize): the position of the coordinate in the range [-r, r]
+// is mapped to [1.5, 2.5[ (i.e. [1, 2[ for the valid range) and the 32 most
+// significant bits of the mantissa are interleaved. The results are therefore
+// bit identical to the scalar implementations.
+namespace geohash::simd {
+
+#ifdef GEOHASH_X86_64
+// Spread out the 32 low bits of each lane into 64 bits, where the bits occupy
+// even bit positions.
+GEOHASH_TARGET("avx2")
+static inline auto spread(__m256i x) -> __m256i {
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 16)),
+                       _mm256_set1_epi64x(0x0000FFFF0000FFFFLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 8)),
+                       _mm256_set1_epi64x(0x00FF00FF00FF00FFLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 4)),
+                       _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0FLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 2)),
+                       _mm256_set1_epi64x(0x3333333333333333LL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_slli_epi64(x, 1)),
+                       _mm256_set1_epi64x(0x5555555555555555LL));
+  return x;
+}
+
+// Encode the position of the coordinates within the range defined by the
+// scale factor as 32-bit integers stored in 64-bit lanes.
+GEOHASH_TARGET("avx2")
+static inline auto encode_range(const __m256d x, const double scale)
+    -> __m256i {
+  auto p = _mm256_add_pd(_mm256_set1_pd(1.5),
+                         _mm256_mul_pd(x, _mm256_set1_pd(scale)));
+  return _mm256_and_si256(_mm256_srli_epi64(_mm256_castpd_si256(p), 20),
+                          _mm256_set1_epi64x(0xFFFFFFFFLL));
+}
+
+// Encode the positions defined by the longitudes and latitudes into geohash
+// shifted right by "shift" bits.
+GEOHASH_TARGET("avx2")
+static inline auto encode(const __m256d lng, const __m256d lat,
+                          const __m128i shift) -> __m256i {
+  const auto all_ones = _mm256_set1_epi64x(0xFFFFFFFFLL);
+  auto y = _mm256_blendv_epi8(
+      encode_range(lat, 0.005555555555555556), all_ones,
+      _mm256_castpd_si256(
+          _mm256_cmp_pd(lat, _mm256_set1_pd(90.0), _CMP_EQ_OQ)));
+  auto x = _mm256_blendv_epi8(
+      encode_range(lng, 0.002777777777777778), all_ones,
+      _mm256_castpd_si256(
+          _mm256_cmp_pd(lng, _mm256_set1_pd(180.0), _CMP_EQ_OQ)));
+  return _mm256_srl_epi64(
+      _mm256_or_si256(_mm256_slli_epi64(spread(x), 1), spread(y)), shift);
+}
+
+// Loads 4 coordinates converted to double.
+GEOHASH_TARGET("avx2")
+static inline auto load4(const double* ptr) -> __m256d {
+  return _mm256_loadu_pd(ptr);
+}
+
+// Loads 4 coordinates converted to double.
+GEOHASH_TARGET("avx2")
+static inline auto load4(const float* ptr) -> __m256d {
+  return _mm256_cvtps_pd(_mm_loadu_ps(ptr));
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto encode_avx2(const Point* points, const size_t size,
+                 const uint32_t precision, uint64_t* hashs) -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(64 - precision));
+  const auto count = size & ~size_t(3);
+  auto src = reinterpret_cast<const double*>(points);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    // [lng0, lat0, lng1, lat1], [lng2, lat2, lng3, lat3]
+    auto p01 = _mm256_loadu_pd(src);
+    auto p23 = _mm256_loadu_pd(src + 4);
+    src += 8;
+
+    // [lng0, lng2, lng1, lng3], [lat0, lat2, lat1, lat3]
+    auto hash = encode(_mm256_unpacklo_pd(p01, p23),
+                       _mm256_unpackhi_pd(p01, p23), shift);
+
+    // Restores the order of the points: [0, 2, 1, 3] -> [0, 1, 2, 3]
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hashs + ix),
+                        _mm256_permute4x64_epi64(hash, 0xd8));
+  }
+  return count;
+}
+
+// Encode the coordinates given as separate arrays, 4 points at a time.
+template <typename T>
+GEOHASH_TARGET("avx2")
+static auto encode_lnglat_avx2(const T* lng, const T* lat, const size_t size,
+                               const uint32_t precision, uint64_t* hashs)
+    -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(64 - precision));
+  const auto count = size & ~size_t(3);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(hashs + ix),
+                        encode(load4(lng + ix), load4(lat + ix), shift));
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx2(const double* lng, const double* lat, const size_t size,
+                 const uint32_t precision, uint64_t* hashs) -> size_t {
+  return encode_lnglat_avx2(lng, lat, size, precision, hashs);
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx2(const float* lng, const float* lat, const size_t size,
+                 const uint32_t precision, uint64_t* hashs) -> size_t {
+  return encode_lnglat_avx2(lng, lat, size, precision, hashs);
+}
+
+// Squash the even bit levels of each lane into its 32 low bits.
+GEOHASH_TARGET("avx2")
+static inline auto squash(__m256i x) -> __m256i {
+  x = _mm256_and_si256(x, _mm256_set1_epi64x(0x5555555555555555LL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 1)),
+                       _mm256_set1_epi64x(0x3333333333333333LL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 2)),
+                       _mm256_set1_epi64x(0x0F0F0F0F0F0F0F0FLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 4)),
+                       _mm256_set1_epi64x(0x00FF00FF00FF00FFLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 8)),
+                       _mm256_set1_epi64x(0x0000FFFF0000FFFFLL));
+  x = _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 16)),
+                       _mm256_set1_epi64x(0x00000000FFFFFFFFLL));
+  return x;
+}
+
+// Decode the 32-bit range encodings stored in the 64-bit lanes back to values
+// in the range -r to +r (see kernel::decode_range).
+GEOHASH_TARGET("avx2")
+static inline auto decode_range(const __m256i x, const double r) -> __m256d {
+  // The 32-bit integers are converted exactly by placing them in the mantissa
+  // of 2^52.
+  auto value = _mm256_sub_pd(
+      _mm256_castsi256_pd(
+          _mm256_or_si256(x, _mm256_set1_epi64x(0x4330000000000000LL))),
+      _mm256_set1_pd(4503599627370496.0));
+  auto p = _mm256_mul_pd(value, _mm256_set1_pd(1.0 / 4294967296.0));
+  auto result = _mm256_sub_pd(_mm256_mul_pd(_mm256_set1_pd(2 * r), p),
+                              _mm256_set1_pd(r));
+  return _mm256_blendv_pd(
+      result, _mm256_set1_pd(r),
+      _mm256_castsi256_pd(
+          _mm256_cmpeq_epi64(x, _mm256_set1_epi64x(0xFFFFFFFFLL))));
+}
+
+// Returns the point of the cells whose minimum corner is "x" (see
+// kernel::Decoder::decode).
+GEOHASH_TARGET("avx2")
+static inline auto decode_cell(const __m256d x, const double err,
+                               const double step, const bool round)
+    -> __m256d {
+  if (round) {
+    const auto y = _mm256_set1_pd(step);
+    return _mm256_mul_pd(
+        _mm256_round_pd(_mm256_div_pd(x, y),
+                        _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC),
+        y);
+  }
+  return _mm256_mul_pd(
+      _mm256_add_pd(x, _mm256_add_pd(x, _mm256_set1_pd(err))),
+      _mm256_set1_pd(0.5));
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto decode_avx2(const uint64_t* hashs, const size_t size,
+                 const kernel::Decoder& decoder, const bool round,
+                 Point* points) -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(decoder.shift));
+  const auto count = size & ~size_t(3);
+  auto dst = reinterpret_cast<double*>(points);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    auto hash = _mm256_sll_epi64(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hashs + ix)),
+        shift);
+    auto lat = decode_cell(decode_range(squash(hash), 90), decoder.lat_err,
+                           decoder.lat_round, round);
+    auto lng =
+        decode_cell(decode_range(squash(_mm256_srli_epi64(hash, 1)), 180),
+                    decoder.lng_err, decoder.lng_round, round);
+
+    // [lng0, lat0, lng2, lat2], [lng1, lat1, lng3, lat3]
+    auto lo = _mm256_unpacklo_pd(lng, lat);
+    auto hi = _mm256_unpackhi_pd(lng, lat);
+    _mm256_storeu_pd(dst, _mm256_permute2f128_pd(lo, hi, 0x20));
+    _mm256_storeu_pd(dst + 4, _mm256_permute2f128_pd(lo, hi, 0x31));
+    dst += 8;
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto decode_boxes_avx2(const uint64_t* hashs, const size_t size,
+                       const kernel::Decoder& decoder, double* lng_min,
+                       double* lat_min, double* lng_max, double* lat_max)
+    -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(decoder.shift));
+  const auto lng_err = _mm256_set1_pd(decoder.lng_err);
+  const auto lat_err = _mm256_set1_pd(decoder.lat_err);
+  const auto count = size & ~size_t(3);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    auto hash = _mm256_sll_epi64(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(hashs + ix)),
+        shift);
+    auto lat = decode_range(squash(hash), 90);
+    auto lng = decode_range(squash(_mm256_srli_epi64(hash, 1)), 180);
+    _mm256_storeu_pd(lng_min + ix, lng);
+    _mm256_storeu_pd(lat_min + ix, lat);
+    _mm256_storeu_pd(lng_max + ix, _mm256_add_pd(lng, lng_err));
+    _mm256_storeu_pd(lat_max + ix, _mm256_add_pd(lat, lat_err));
+  }
+  return count;
+}
+
+// Spread out the 32 low bits of each lane into 64 bits, where the bits occupy
+// even bit positions.
+GEOHASH_TARGET("avx512f")
+static inline auto spread(__m512i x) -> __m512i {
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_slli_epi64(x, 16)),
+                       _mm512_set1_epi64(0x0000FFFF0000FFFFLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_slli_epi64(x, 8)),
+                       _mm512_set1_epi64(0x00FF00FF00FF00FFLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_slli_epi64(x, 4)),
+                       _mm512_set1_epi64(0x0F0F0F0F0F0F0F0FLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_slli_epi64(x, 2)),
+                       _mm512_set1_epi64(0x3333333333333333LL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_slli_epi64(x, 1)),
+                       _mm512_set1_epi64(0x5555555555555555LL));
+  return x;
+}
+
+// Encode the position of the coordinates within the range defined by the
+// scale factor as 32-bit integers stored in 64-bit lanes.
+GEOHASH_TARGET("avx512f")
+static inline auto encode_range(const __m512d x, const double scale)
+    -> __m512i {
+  auto p = _mm512_add_pd(_mm512_set1_pd(1.5),
+                         _mm512_mul_pd(x, _mm512_set1_pd(scale)));
+  return _mm512_and_si512(_mm512_srli_epi64(_mm512_castpd_si512(p), 20),
+                          _mm512_set1_epi64(0xFFFFFFFFLL));
+}
+
+// Encode the positions defined by the longitudes and latitudes into geohash
+// shifted right by "shift" bits.
+GEOHASH_TARGET("avx512f")
+static inline auto encode(const __m512d lng, const __m512d lat,
+                          const __m128i shift) -> __m512i {
+  const auto all_ones = _mm512_set1_epi64(0xFFFFFFFFLL);
+  auto y = _mm512_mask_mov_epi64(
+      encode_range(lat, 0.005555555555555556),
+      _mm512_cmp_pd_mask(lat, _mm512_set1_pd(90.0), _CMP_EQ_OQ), all_ones);
+  auto x = _mm512_mask_mov_epi64(
+      encode_range(lng, 0.002777777777777778),
+      _mm512_cmp_pd_mask(lng, _mm512_set1_pd(180.0), _CMP_EQ_OQ), all_ones);
+  return _mm512_srl_epi64(
+      _mm512_or_si512(_mm512_slli_epi64(spread(x), 1), spread(y)), shift);
+}
+
+// Loads 8 coordinates converted to double.
+GEOHASH_TARGET("avx512f")
+static inline auto load8(const double* ptr) -> __m512d {
+  return _mm512_loadu_pd(ptr);
+}
+
+// Loads 8 coordinates converted to double.
+GEOHASH_TARGET("avx512f")
+static inline auto load8(const float* ptr) -> __m512d {
+  return _mm512_cvtps_pd(_mm256_loadu_ps(ptr));
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx512f")
+auto encode_avx512(const Point* points, const size_t size,
+                   const uint32_t precision, uint64_t* hashs) -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(64 - precision));
+  const auto lng_index = _mm512_set_epi64(14, 12, 10, 8, 6, 4, 2, 0);
+  const auto lat_index = _mm512_set_epi64(15, 13, 11, 9, 7, 5, 3, 1);
+  const auto count = size & ~size_t(7);
+  auto src = reinterpret_cast<const double*>(points);
+
+  for (size_t ix = 0; ix < count; ix += 8) {
+    auto p0 = _mm512_loadu_pd(src);
+    auto p1 = _mm512_loadu_pd(src + 8);
+    src += 16;
+
+    _mm512_storeu_si512(hashs + ix,
+                        encode(_mm512_permutex2var_pd(p0, lng_index, p1),
+                               _mm512_permutex2var_pd(p0, lat_index, p1),
+                               shift));
+  }
+  return count;
+}
+
+// Encode the coordinates given as separate arrays, 8 points at a time.
+template <typename T>
+GEOHASH_TARGET("avx512f")
+static auto encode_lnglat_avx512(const T* lng, const T* lat, const size_t size,
+                                 const uint32_t precision, uint64_t* hashs)
+    -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(64 - precision));
+  const auto count = size & ~size_t(7);
+
+  for (size_t ix = 0; ix < count; ix += 8) {
+    _mm512_storeu_si512(hashs + ix,
+                        encode(load8(lng + ix), load8(lat + ix), shift));
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx512(const double* lng, const double* lat, const size_t size,
+                   const uint32_t precision, uint64_t* hashs) -> size_t {
+  return encode_lnglat_avx512(lng, lat, size, precision, hashs);
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx512(const float* lng, const float* lat, const size_t size,
+                   const uint32_t precision, uint64_t* hashs) -> size_t {
+  return encode_lnglat_avx512(lng, lat, size, precision, hashs);
+}
+
+// Squash the even bit levels of each lane into its 32 low bits.
+GEOHASH_TARGET("avx512f")
+static inline auto squash(__m512i x) -> __m512i {
+  x = _mm512_and_si512(x, _mm512_set1_epi64(0x5555555555555555LL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_srli_epi64(x, 1)),
+                       _mm512_set1_epi64(0x3333333333333333LL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_srli_epi64(x, 2)),
+                       _mm512_set1_epi64(0x0F0F0F0F0F0F0F0FLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_srli_epi64(x, 4)),
+                       _mm512_set1_epi64(0x00FF00FF00FF00FFLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_srli_epi64(x, 8)),
+                       _mm512_set1_epi64(0x0000FFFF0000FFFFLL));
+  x = _mm512_and_si512(_mm512_or_si512(x, _mm512_srli_epi64(x, 16)),
+                       _mm512_set1_epi64(0x00000000FFFFFFFFLL));
+  return x;
+}
+
+// Decode the 32-bit range encodings stored in the 64-bit lanes back to values
+// in the range -r to +r (see kernel::decode_range).
+GEOHASH_TARGET("avx512f")
+static inline auto decode_range(const __m512i x, const double r) -> __m512d {
+  // The 32-bit integers are converted exactly by placing them in the mantissa
+  // of 2^52.
+  auto value = _mm512_sub_pd(
+      _mm512_castsi512_pd(
+          _mm512_or_si512(x, _mm512_set1_epi64(0x4330000000000000LL))),
+      _mm512_set1_pd(4503599627370496.0));
+  auto p = _mm512_mul_pd(value, _mm512_set1_pd(1.0 / 4294967296.0));
+  auto result = _mm512_sub_pd(_mm512_mul_pd(_mm512_set1_pd(2 * r), p),
+                              _mm512_set1_pd(r));
+  return _mm512_mask_mov_pd(
+      result, _mm512_cmpeq_epi64_mask(x, _mm512_set1_epi64(0xFFFFFFFFLL)),
+      _mm512_set1_pd(r));
+}
+
+// Returns the point of the cells whose minimum corner is "x" (see
+// kernel::Decoder::decode).
+GEOHASH_TARGET("avx512f")
+static inline auto decode_cell(const __m512d x, const double err,
+                               const double step, const bool round)
+    -> __m512d {
+  if (round) {
+    const auto y = _mm512_set1_pd(step);
+    return _mm512_mul_pd(
+        _mm512_roundscale_pd(_mm512_div_pd(x, y),
+                             _MM_FROUND_TO_POS_INF | _MM_FROUND_NO_EXC),
+        y);
+  }
+  return _mm512_mul_pd(
+      _mm512_add_pd(x, _mm512_add_pd(x, _mm512_set1_pd(err))),
+      _mm512_set1_pd(0.5));
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx512f")
+auto decode_avx512(const uint64_t* hashs, const size_t size,
+                   const kernel::Decoder& decoder, const bool round,
+                   Point* points) -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(decoder.shift));
+  // Indexes of the 128-bit lanes of [lng0, lat0, lng2, lat2, ...] (0-7) and
+  // [lng1, lat1, lng3, lat3, ...] (8-15) restoring the order of the points.
+  const auto index0 = _mm512_set_epi64(11, 10, 3, 2, 9, 8, 1, 0);
+  const auto index1 = _mm512_set_epi64(15, 14, 7, 6, 13, 12, 5, 4);
+  const auto count = size & ~size_t(7);
+  auto dst = reinterpret_cast<double*>(points);
+
+  for (size_t ix = 0; ix < count; ix += 8) {
+    auto hash = _mm512_sll_epi64(_mm512_loadu_si512(hashs + ix), shift);
+    auto lat = decode_cell(decode_range(squash(hash), 90), decoder.lat_err,
+                           decoder.lat_round, round);
+    auto lng =
+        decode_cell(decode_range(squash(_mm512_srli_epi64(hash, 1)), 180),
+                    decoder.lng_err, decoder.lng_round, round);
+
+    auto lo = _mm512_unpacklo_pd(lng, lat);
+    auto hi = _mm512_unpackhi_pd(lng, lat);
+    _mm512_storeu_pd(dst, _mm512_permutex2var_pd(lo, index0, hi));
+    _mm512_storeu_pd(dst + 8, _mm512_permutex2var_pd(lo, index1, hi));
+    dst += 16;
+  }
+  return count;
+}
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx512f")
+auto decode_boxes_avx512(const uint64_t* hashs, const size_t size,
+                         const kernel::Decoder& decoder, double* lng_min,
+                         double* lat_min, double* lng_max, double* lat_max)
+    -> size_t {
+  const auto shift = _mm_cvtsi32_si128(static_cast<int>(decoder.shift));
+  const auto lng_err = _mm512_set1_pd(decoder.lng_err);
+  const auto lat_err = _mm512_set1_pd(decoder.lat_err);
+  const auto count = size & ~size_t(7);
+
+  for (size_t ix = 0; ix < count; ix += 8) {
+    auto hash = _mm512_sll_epi64(_mm512_loadu_si512(hashs + ix), shift);
+    auto lat = decode_range(squash(hash), 90);
+    auto lng = decode_range(squash(_mm512_srli_epi64(hash, 1)), 180);
+    _mm512_storeu_pd(lng_min + ix, lng);
+    _mm512_storeu_pd(lat_min + ix, lat);
+    _mm512_storeu_pd(lng_max + ix, _mm512_add_pd(lng, lng_err));
+    _mm512_storeu_pd(lat_max + ix, _mm512_add_pd(lat, lat_err));
+  }
+  return count;
+}
+
+// Returns the number of trailing zero bits of x, which must not be zero.
+static inline auto count_trailing_zeros(const uint32_t x) -> uint32_t {
+#ifdef _WIN32
+  unsigned long index;
+  _BitScanForward(&index, x);
+  return static_cast<uint32_t>(index);
+#else
+  return static_cast<uint32_t>(__builtin_ctz(x));
+#endif
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto encode_base32_avx2(const uint64_t* hashs, const size_t size,
+                        const uint32_t chars, const size_t stride,
+                        char* buffer) -> size_t {
+  // Halves of the base32 alphabet looked up by byte shuffles.
+  const auto lower =
+      _mm_setr_epi8('0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'b', 'c',
+                    'd', 'e', 'f', 'g');
+  const auto upper =
+      _mm_setr_epi8('h', 'j', 'k', 'm', 'n', 'p', 'q', 'r', 's', 't', 'u', 'v',
+                    'w', 'x', 'y', 'z');
+  const auto shift = 60 - 5 * chars;
+  // Index of the first hash whose 16 bytes stored would overflow the buffer.
+  // Storing 16 bytes at once is possible only if the hashs are contiguous.
+  const auto last = stride != chars || size * stride < 16
+                        ? 0
+                        : (size * stride - 16) / stride + 1;
+  alignas(16) char encoded[16];
+  for (size_t ix = 0; ix < size; ++ix) {
+    // The 60 bits of the hash, aligned on the left, are split into three
+    // groups of 20 bits, each group into two words of 10 bits and each word
+    // into two bytes of 5 bits: the byte k holds the index of the character
+    // k.
+    const auto hash = hashs[ix] << shift;
+    auto x = _mm_setr_epi32(static_cast<int>((hash >> 40U) & 0xFFFFFU),
+                            static_cast<int>((hash >> 20U) & 0xFFFFFU),
+                            static_cast<int>(hash & 0xFFFFFU), 0);
+    x = _mm_or_si128(
+        _mm_srli_epi32(x, 10),
+        _mm_slli_epi32(_mm_and_si128(x, _mm_set1_epi32(0x3FF)), 16));
+    x = _mm_or_si128(
+        _mm_srli_epi16(x, 5),
+        _mm_slli_epi16(_mm_and_si128(x, _mm_set1_epi16(0x1F)), 8));
+    // The indexes greater than 15 select the second half of the alphabet.
+    x = _mm_blendv_epi8(_mm_shuffle_epi8(lower, x), _mm_shuffle_epi8(upper, x),
+                        _mm_cmpgt_epi8(x, _mm_set1_epi8(15)));
+    // The bytes written past the hash are overwritten by the next hashs,
+    // unless they are outside the buffer or not rewritten: in that case,
+    // only the characters of the hash are copied.
+    if (ix < last) {
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(buffer + ix * stride), x);
+    } else {
+      _mm_store_si128(reinterpret_cast<__m128i*>(encoded), x);
+      std::memcpy(buffer + ix * stride, encoded, chars);
+    }
+  }
+  return size;
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto decode_base32_avx2(const char* buffer, const size_t size,
+                        const size_t stride, uint64_t* hashs, uint32_t* chars)
+    -> size_t {
+  const auto index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12,
+                                   13, 14, 15);
+  // The last hashs are copied before being loaded, so as not to read past
+  // the end of the buffer.
+  const auto last = size * stride < 16 ? 0 : (size * stride - 16) / stride + 1;
+  alignas(16) char bytes[16] = {};
+  for (size_t ix = 0; ix < size; ++ix) {
+    const auto* ptr = buffer + ix * stride;
+    if (ix >= last) {
+      std::memcpy(bytes, ptr, stride);
+      ptr = bytes;
+    }
+    const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ptr));
+
+    // The hash ends at the first null character or after "stride" bytes:
+    // the bytes of the next hash are ignored.
+    const auto nulls = static_cast<uint32_t>(_mm_movemask_epi8(
+                           _mm_cmpeq_epi8(x, _mm_setzero_si128()))) |
+                       (1U << stride);
+    const auto length = count_trailing_zeros(nulls);
+    const auto mask = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(length)),
+                                     index);
+
+    // The bytes greater than 127 are negative and fail both tests.
+    const auto digit = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('0' - 1)),
+                                     _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), x));
+    const auto above_i = _mm_cmpgt_epi8(x, _mm_set1_epi8('i'));
+    const auto above_l = _mm_cmpgt_epi8(x, _mm_set1_epi8('l'));
+    const auto above_o = _mm_cmpgt_epi8(x, _mm_set1_epi8('o'));
+    const auto letter = _mm_andnot_si128(
+        _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('i')),
+                                  _mm_cmpeq_epi8(x, _mm_set1_epi8('l'))),
+                     _mm_cmpeq_epi8(x, _mm_set1_epi8('o'))),
+        _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8('b' - 1)),
+                      _mm_cmpgt_epi8(_mm_set1_epi8('z' + 1), x)));
+    const auto valid = _mm_or_si128(_mm_or_si128(digit, letter),
+                                    _mm_andnot_si128(mask, _mm_set1_epi8(-1)));
+    if (_mm_movemask_epi8(valid) != 0xFFFF) {
+      return ix;
+    }
+
+    // The letters i, l and o are missing from the alphabet: the comparisons
+    // with them, equal to -1 when true, shift the indexes of the next letters.
+    auto value = _mm_add_epi8(
+        _mm_sub_epi8(x, _mm_set1_epi8('b' - 10)),
+        _mm_add_epi8(above_i, _mm_add_epi8(above_l, above_o)));
+    value = _mm_blendv_epi8(value, _mm_sub_epi8(x, _mm_set1_epi8('0')), digit);
+    value = _mm_and_si128(value, mask);
+
+    // Packs the indexes of 5 bits: two bytes into a word of 10 bits, then
+    // two words into a double word of 20 bits.
+    value = _mm_maddubs_epi16(value, _mm_set1_epi16(0x0120));
+    value = _mm_madd_epi16(value, _mm_set1_epi32(0x00010400));
+    const auto hash =
+        (static_cast<uint64_t>(_mm_cvtsi128_si32(value)) << 40U) |
+        (static_cast<uint64_t>(_mm_extract_epi32(value, 1)) << 20U) |
+        static_cast<uint64_t>(_mm_extract_epi32(value, 2));
+    hashs[ix] = hash >> (60 - 5 * length);
+    chars[ix] = length;
+  }
+  return size;
+}
+
+// Bounds of a box broadcast in the lanes of vectors. If the box wraps around
+// the antimeridian, a longitude is within the box if it is greater than the
+// minimum or less than the maximum.
+struct BoxBounds {
+  GEOHASH_TARGET("avx2")
+  explicit BoxBounds(const Box& box)
+      : lng_min(_mm256_set1_pd(box.min_corner().lng)),
+        lat_min(_mm256_set1_pd(box.min_corner().lat)),
+        lng_max(_mm256_set1_pd(box.max_corner().lng)),
+        lat_max(_mm256_set1_pd(box.max_corner().lat)),
+        wrap(_mm256_castsi256_pd(_mm256_set1_epi64x(
+            box.min_corner().lng > box.max_corner().lng ? -1 : 0))) {}
+
+  // Returns the mask of the lanes within the box. The comparisons are false
+  // for NaN, as the scalar comparisons.
+  GEOHASH_TARGET("avx2")
+  [[nodiscard]] inline auto contains(const __m256d lng, const __m256d lat) const
+      -> int {
+    const auto ge = _mm256_cmp_pd(lng, lng_min, _CMP_GE_OQ);
+    const auto le = _mm256_cmp_pd(lng, lng_max, _CMP_LE_OQ);
+    const auto inside =
+        _mm256_or_pd(_mm256_and_pd(ge, le),
+                     _mm256_and_pd(wrap, _mm256_or_pd(ge, le)));
+    return _mm256_movemask_pd(_mm256_and_pd(
+        inside, _mm256_and_pd(_mm256_cmp_pd(lat, lat_min, _CMP_GE_OQ),
+                              _mm256_cmp_pd(lat, lat_max, _CMP_LE_OQ))));
+  }
+
+  __m256d lng_min;
+  __m256d lat_min;
+  __m256d lng_max;
+  __m256d lat_max;
+  __m256d wrap;
+};
+
+// Stores the 4 bits of a lane mask as 4 booleans.
+static inline auto store_mask(const int bits, bool* mask) -> void {
+  const auto value = static_cast<uint32_t>(bits & 1) |
+                     (static_cast<uint32_t>(bits & 2) << 7U) |
+                     (static_cast<uint32_t>(bits & 4) << 14U) |
+                     (static_cast<uint32_t>(bits & 8) << 21U);
+  std::memcpy(mask, &value, sizeof(value));
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto box_contains_avx2(const Point* points, const size_t size, const Box& box,
+                       bool* mask) -> size_t {
+  const auto bounds = BoxBounds(box);
+  const auto count = size & ~size_t(3);
+  const auto* ptr = reinterpret_cast<const double*>(points);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    // (lng0, lat0, lng1, lat1) and (lng2, lat2, lng3, lat3) are unpacked into
+    // (lng0, lng2, lng1, lng3) and (lat0, lat2, lat1, lat3).
+    const auto first = _mm256_loadu_pd(ptr + 2 * ix);
+    const auto second = _mm256_loadu_pd(ptr + 2 * ix + 4);
+    const auto bits = bounds.contains(_mm256_unpacklo_pd(first, second),
+                                      _mm256_unpackhi_pd(first, second));
+    // The bits of the points 1 and 2 are swapped back.
+    store_mask((bits & 9) | ((bits & 2) << 1) | ((bits & 4) >> 1), mask + ix);
+  }
+  return count;
+}
+
+// ---------------------------------------------------------------------------
+GEOHASH_TARGET("avx2")
+auto box_contains_avx2(const double* lng, const double* lat, const size_t size,
+                       const Box& box, bool* mask) -> size_t {
+  const auto bounds = BoxBounds(box);
+  const auto count = size & ~size_t(3);
+
+  for (size_t ix = 0; ix < count; ix += 4) {
+    store_mask(bounds.contains(_mm256_loadu_pd(lng + ix),
+                               _mm256_loadu_pd(lat + ix)),
+               mask + ix);
+  }
+  return count;
+}
+#else
+// ---------------------------------------------------------------------------
+auto encode_avx2(const Point* /*points*/, const size_t /*size*/,
+                 const uint32_t /*precision*/, uint64_t* /*hashs*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx512(const Point* /*points*/, const size_t /*size*/,
+                   const uint32_t /*precision*/, uint64_t* /*hashs*/)
+    -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx2(const double* /*lng*/, const double* /*lat*/,
+                 const size_t /*size*/, const uint32_t /*precision*/,
+                 uint64_t* /*hashs*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx2(const float* /*lng*/, const float* /*lat*/,
+                 const size_t /*size*/, const uint32_t /*precision*/,
+                 uint64_t* /*hashs*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx512(const double* /*lng*/, const double* /*lat*/,
+                   const size_t /*size*/, const uint32_t /*precision*/,
+                   uint64_t* /*hashs*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto encode_avx512(const float* /*lng*/, const float* /*lat*/,
+                   const size_t /*size*/, const uint32_t /*precision*/,
+                   uint64_t* /*hashs*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto decode_avx2(const uint64_t* /*hashs*/, const size_t /*size*/,
+                 const kernel::Decoder& /*decoder*/, const bool /*round*/,
+                 Point* /*points*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto decode_avx512(const uint64_t* /*hashs*/, const size_t /*size*/,
+                   const kernel::Decoder& /*decoder*/, const bool /*round*/,
+                   Point* /*points*/) -> size_t {
+  return 0;
+}
+// ---------------------------------------------------------------------------
+auto decode_boxes_avx2(const uint64_t* /*hashs*/, const size_t /*size*/,
+                       const kernel::Decoder& /*decoder*/,
+                       double* /*lng_min*/, double* /*lat_min*/,
+                       double* /*lng_max*/, double* /*lat_max*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto decode_boxes_avx512(const uint64_t* /*hashs*/, const size_t /*size*/,
+                         const kernel::Decoder& /*decoder*/,
+                         double* /*lng_min*/, double* /*lat_min*/,
+                         double* /*lng_max*/, double* /*lat_max*/) -> size_t {
+  return 0;
+}
+// ---------------------------------------------------------------------------
+auto encode_base32_avx2(const uint64_t* /*hashs*/, const size_t /*size*/,
+                        const uint32_t /*chars*/, const size_t /*stride*/,
+                        char* /*buffer*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto decode_base32_avx2(const char* /*buffer*/, const size_t /*size*/,
+                        const size_t /*stride*/, uint64_t* /*hashs*/,
+                        uint32_t* /*chars*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto box_contains_avx2(const Point* /*points*/, const size_t /*size*/,
+                       const Box& /*box*/, bool* /*mask*/) -> size_t {
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+auto box_contains_avx2(const double* /*lng*/, const double* /*lat*/,
+                       const size_t /*size*/, const Box& /*box*/,
+                       bool* /*mask*/) -> size_t {
+  return 0;
+}
+#endif
+
+}  // namespace geohash::simd
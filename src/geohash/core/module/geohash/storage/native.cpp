@@ -0,0 +1,253 @@
+#include "geohash/storage/native.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace geohash::storage::native {
+
+// Layout of the header, all integers being stored in the byte order of the
+// host:
+//
+//   uint32  number of items
+//   for each item:
+//     uint8   kArray or kTuple
+//     uint32  number of arrays, only for the tuples
+//     for each array:
+//       uint8   length of the dtype
+//       char[]  dtype, as returned by numpy.dtype.str
+//       uint8   number of dimensions
+//       int64[] shape
+//       int64[] strides
+//       uint64  position of the data
+//       uint64  size of the data
+static constexpr uint8_t kArray = 0;
+static constexpr uint8_t kTuple = 1;
+
+// Maximum number of dimensions of the arrays serialized, numpy >= 2 allowing
+// up to 64 dimensions.
+static constexpr size_t kMaxDims = 32;
+
+// ---------------------------------------------------------------------------
+template <typename T>
+static auto put(std::string& buffer, const T value) -> void {
+  buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// ---------------------------------------------------------------------------
+static auto align(const size_t size) -> size_t {
+  return (size + kAlignment - 1) & ~(kAlignment - 1);
+}
+
+// ---------------------------------------------------------------------------
+// Reads the serialized values checking that the buffer is not overrun.
+class Reader {
+ public:
+  Reader(const char* buffer, const size_t size) : ptr_(buffer), size_(size) {}
+
+  template <typename T>
+  auto get() -> T {
+    auto result = T();
+    std::memcpy(&result, read(sizeof(T)), sizeof(T));
+    return result;
+  }
+
+  auto read(const size_t size) -> const char* {
+    if (size_ - pos_ < size) {
+      throw std::runtime_error("corrupted values");
+    }
+    auto result = ptr_ + pos_;
+    pos_ += size;
+    return result;
+  }
+
+ private:
+  const char* ptr_;
+  size_t size_;
+  size_t pos_{0};
+};
+
+// ---------------------------------------------------------------------------
+auto Encoder::prepare(const pybind11::list& values) -> std::optional<Encoder> {
+  const auto ndarray = pybind11::module::import("numpy").attr("ndarray");
+  auto result = Encoder();
+
+  // The subclasses of ndarray, such as masked arrays, are not handled.
+  auto add_array = [&](const pybind11::handle& item) -> bool {
+    if (!item.get_type().is(ndarray)) {
+      return false;
+    }
+    auto array = pybind11::reinterpret_borrow<pybind11::array>(item);
+    const auto dtype = array.dtype();
+    if (pybind11::cast<bool>(dtype.attr("hasobject")) ||
+        !dtype.attr("fields").is_none() || !dtype.attr("subdtype").is_none()) {
+      return false;
+    }
+    const auto str = pybind11::cast<std::string>(dtype.attr("str"));
+    if (str.size() > UINT8_MAX ||
+        static_cast<size_t>(array.ndim()) > kMaxDims) {
+      return false;
+    }
+    if ((array.flags() & (pybind11::array::c_style |
+                          pybind11::array::f_style)) == 0) {
+      array = pybind11::array::ensure(array, pybind11::array::c_style);
+      if (!array) {
+        throw pybind11::error_already_set();
+      }
+    }
+    put(result.header_, static_cast<uint8_t>(str.size()));
+    result.header_ += str;
+    put(result.header_, static_cast<uint8_t>(array.ndim()));
+    for (pybind11::ssize_t ix = 0; ix < array.ndim(); ++ix) {
+      put(result.header_, static_cast<int64_t>(array.shape(ix)));
+    }
+    for (pybind11::ssize_t ix = 0; ix < array.ndim(); ++ix) {
+      put(result.header_, static_cast<int64_t>(array.strides(ix)));
+    }
+    // The position of the data is known once the header is complete.
+    result.blocks_.push_back({static_cast<const char*>(array.data()),
+                              static_cast<size_t>(array.nbytes()),
+                              result.header_.size()});
+    put(result.header_, uint64_t(0));
+    put(result.header_, static_cast<uint64_t>(array.nbytes()));
+    result.arrays_.emplace_back(std::move(array));
+    return true;
+  };
+
+  put(result.header_, static_cast<uint32_t>(values.size()));
+  for (const auto& item : values) {
+    if (PyTuple_Check(item.ptr())) {
+      const auto tuple = pybind11::reinterpret_borrow<pybind11::tuple>(item);
+      put(result.header_, kTuple);
+      put(result.header_, static_cast<uint32_t>(tuple.size()));
+      for (const auto& array : tuple) {
+        if (!add_array(array)) {
+          return {};
+        }
+      }
+    } else {
+      put(result.header_, kArray);
+      if (!add_array(item)) {
+        return {};
+      }
+    }
+  }
+
+  // Position of the data of the arrays.
+  result.size_ = align(result.header_.size());
+  for (auto& block : result.blocks_) {
+    const auto offset = static_cast<uint64_t>(result.size_);
+    std::memcpy(result.header_.data() + block.offset, &offset, sizeof(offset));
+    block.offset = result.size_;
+    result.size_ = align(result.size_ + block.size);
+  }
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+auto Encoder::write(char* buffer) const -> void {
+  std::memset(buffer, 0, size_);
+  std::memcpy(buffer, header_.data(), header_.size());
+  for (const auto& block : blocks_) {
+    std::memcpy(buffer + block.offset, block.ptr, block.size);
+  }
+}
+
+// ---------------------------------------------------------------------------
+Decoder::Decoder(const char* buffer, const size_t size) {
+  auto reader = Reader(buffer, size);
+
+  auto read_array = [&]() {
+    auto array = Array();
+    const auto length = reader.get<uint8_t>();
+    array.dtype = std::string(reader.read(length), length);
+    const auto ndim = reader.get<uint8_t>();
+    if (ndim > kMaxDims) {
+      throw std::runtime_error("corrupted values");
+    }
+    for (auto ix = 0; ix < ndim; ++ix) {
+      array.shape.push_back(
+          static_cast<pybind11::ssize_t>(reader.get<int64_t>()));
+    }
+    for (auto ix = 0; ix < ndim; ++ix) {
+      array.strides.push_back(
+          static_cast<pybind11::ssize_t>(reader.get<int64_t>()));
+    }
+    array.offset = static_cast<size_t>(reader.get<uint64_t>());
+    array.size = static_cast<size_t>(reader.get<uint64_t>());
+    if (array.offset > size || array.size > size - array.offset) {
+      throw std::runtime_error("corrupted values");
+    }
+    arrays_.emplace_back(std::move(array));
+  };
+
+  const auto items = reader.get<uint32_t>();
+  items_.reserve(items);
+  for (uint32_t ix = 0; ix < items; ++ix) {
+    switch (reader.get<uint8_t>()) {
+      case kArray:
+        read_array();
+        items_.push_back(-1);
+        break;
+      case kTuple: {
+        const auto count = reader.get<uint32_t>();
+        for (uint32_t jx = 0; jx < count; ++jx) {
+          read_array();
+        }
+        items_.push_back(count);
+      } break;
+      default:
+        throw std::runtime_error("corrupted values");
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+auto Decoder::values(char* buffer, const pybind11::handle& owner) const
+    -> pybind11::list {
+  auto to_array = [&](const Array& item) -> pybind11::array {
+    auto dtype = pybind11::dtype(item.dtype);
+    // The elements addressed by the shape and strides must lie in the data
+    // of the array.
+    auto extent = static_cast<size_t>(dtype.itemsize());
+    for (size_t ix = 0; ix < item.shape.size(); ++ix) {
+      if (item.shape[ix] == 0) {
+        extent = 0;
+        break;
+      }
+      if (item.shape[ix] < 0) {
+        throw std::runtime_error("corrupted values");
+      }
+      // The strides of the dimensions of length 1 are meaningless.
+      if (item.shape[ix] == 1) {
+        continue;
+      }
+      if (item.strides[ix] < 0) {
+        throw std::runtime_error("corrupted values");
+      }
+      extent += static_cast<size_t>(item.shape[ix] - 1) *
+                static_cast<size_t>(item.strides[ix]);
+    }
+    if (extent > item.size) {
+      throw std::runtime_error("corrupted values");
+    }
+    return pybind11::array(dtype, item.shape, item.strides,
+                           buffer + item.offset, owner);
+  };
+
+  auto result = pybind11::list(items_.size());
+  auto array = arrays_.begin();
+  for (size_t ix = 0; ix < items_.size(); ++ix) {
+    if (items_[ix] == -1) {
+      result[ix] = to_array(*array++);
+      continue;
+    }
+    auto tuple = pybind11::tuple(items_[ix]);
+    for (int64_t jx = 0; jx < items_[ix]; ++jx) {
+      tuple[jx] = to_array(*array++);
+    }
+    result[ix] = tuple;
+  }
+  return result;
+}
+
+}  // namespace geohash::storage::native
@@ -1,11 +1,65 @@
 #include "geohash/storage/unqlite.hpp"
 
+#include <lz4.h>
+#include <lz4hc.h>
 #include <snappy.h>
+#include <zdict.h>
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "geohash/parallel.hpp"
+#include "geohash/storage/native.hpp"
 
 namespace geohash::storage::unqlite {
 
+// Minimum number of values compressed or uncompressed by a thread.
+static constexpr size_t kMinValuesPerThread = 256;
+
+// A record is a sequence of frames, each holding a list of values pickled and
+// compressed independently, so that values can be appended to a record
+// without rewriting it. A frame starts with a header of kFrameHeaderSize
+// bytes: the codec used, combined with kFrameFlag, then the size of the
+// compressed data as a 32-bit little-endian integer.
+//
+// The frames holding values serialized by the native codec, instead of
+// pickle, are marked by kNativeFlag.
+//
+// The records written by previous versions hold a single frame without size:
+// the codec, without kFrameFlag, followed by the compressed data.
+static constexpr uint8_t kFrameFlag = 0x80;
+static constexpr uint8_t kNativeFlag = 0x40;
+static constexpr size_t kFrameHeaderSize = 5;
+
+// The Zstandard dictionaries are stored in the database under the keys
+// kDictionaryKey followed by their ID, the dictionary used to compress the
+// values being also stored under kDictionaryKey. These keys are hidden.
+static constexpr char kDictionaryKey[] = "__geohash_zstd_dictionary__";
+static constexpr size_t kDictionaryKeySize = sizeof(kDictionaryKey) - 1;
+
+// Maximum size of the samples used to train a dictionary, relative to its
+// capacity.
+static constexpr size_t kMaxSamplesRatio = 100;
+
+// Compressed data of a frame.
+struct Frame {
+  // Codec used to compress the data.
+  uint8_t codec;
+  // True if the values are serialized by the native codec.
+  bool native;
+  // Position of the data in the buffer holding the record.
+  size_t offset;
+  // Size of the data.
+  size_t size;
+};
+
 struct Slice {
   char* ptr;
   Py_ssize_t len;
@@ -146,12 +200,33 @@ static auto decode_mode(const std::string& mode) -> unsigned int {
 // ---------------------------------------------------------------------------
 Database::Database(std::string name,
                    const std::optional<std::string>& open_mode,
-                   const CompressionType compression_type)
+                   const CompressionType compression_type,
+                   const SerializationType serialization_type,
+                   const int compression_level)
     : name_(std::move(name)),
       open_mode_(open_mode.value_or("rm")),
-      compression_type_(compression_type) {
+      compression_type_(compression_type),
+      serialization_type_(serialization_type),
+      compression_level_(compression_level) {
+  // The level 0 selects the default level of the algorithm.
+  if ((compression_type_ == kLZ4Compression &&
+       (compression_level_ < 0 || compression_level_ > LZ4HC_CLEVEL_MAX)) ||
+      (compression_type_ == kZstdCompression &&
+       (compression_level_ < ZSTD_minCLevel() ||
+        compression_level_ > ZSTD_maxCLevel()))) {
+    throw std::invalid_argument("invalid compression level: " +
+                                std::to_string(compression_level_));
+  }
   auto mode = decode_mode(open_mode_);
   handle_rc(unqlite_open(&handle_, name_.c_str(), mode));
+
+  if (compression_type_ == kZstdCompression) {
+    auto content = std::string();
+    if (fetch(kDictionaryKey, static_cast<int>(kDictionaryKeySize),
+              content)) {
+      set_dictionary(content);
+    }
+  }
 }
 
 // ---------------------------------------------------------------------------
@@ -163,220 +238,803 @@ Database::~Database() {
   }
 }
 
-// ---------------------------------------------------------------------------
-static auto no_compress(const Slice& slice) -> pybind11::bytes {
-  auto result = pybind11::reinterpret_steal<pybind11::bytes>(
-      PyBytes_FromStringAndSize(nullptr, slice.len + 1));
-  auto buffer = PyBytes_AS_STRING(result.ptr());
-
-  // We store the type of compression used
-  buffer[0] = kNoCompression;
-  ++buffer;
-
-  memcpy(buffer, slice.ptr, sizeof(*buffer) * slice.len);
-  return result;
-}
-
 // ---------------------------------------------------------------------------
 auto Database::getstate() const -> pybind11::tuple {
   if (name_ == ":mem:") {
     throw std::runtime_error("Cannot pickle in-memory databases");
   }
-  return pybind11::make_tuple(name_, open_mode_, compression_type_);
+  return pybind11::make_tuple(name_, open_mode_, compression_type_,
+                              serialization_type_, compression_level_);
 }
 
 // ---------------------------------------------------------------------------
 auto Database::setstate(const pybind11::tuple& state)
     -> std::shared_ptr<Database> {
-  if (pybind11::len(state) != 3) {
+  // The states saved by previous versions do not hold the serialization and
+  // the compression level.
+  const auto size = pybind11::len(state);
+  if (size < 3 || size > 5) {
     throw std::invalid_argument("invalid state");
   }
-  return std::make_shared<Database>(state[0].cast<std::string>(),
-                                    state[1].cast<std::string>(),
-                                    state[2].cast<CompressionType>());
+  return std::make_shared<Database>(
+      state[0].cast<std::string>(), state[1].cast<std::string>(),
+      state[2].cast<CompressionType>(),
+      size > 3 ? state[3].cast<SerializationType>() : kPickleSerialization,
+      size > 4 ? state[4].cast<int>() : 0);
 }
 
 // ---------------------------------------------------------------------------
-static auto snappy_compress(const Slice& slice) -> pybind11::bytes {
-  auto compressed_len = snappy::MaxCompressedLength(slice.len);
-  auto result = pybind11::reinterpret_steal<pybind11::bytes>(
-      PyBytes_FromStringAndSize(nullptr, compressed_len + 1));
-  auto buffer = PyBytes_AS_STRING(result.ptr());
+// Writes a 32-bit little-endian integer.
+static auto write_uint32(char* ptr, size_t value) -> void {
+  if (value > std::numeric_limits<uint32_t>::max()) {
+    throw OperationalError("value too large");
+  }
+  for (size_t ix = 0; ix < sizeof(uint32_t); ++ix) {
+    ptr[ix] = static_cast<char>(value & 0xff);
+    value >>= 8;
+  }
+}
 
-  // We store the type of compression used
-  buffer[0] = kSnappyCompression;
-  ++buffer;
+// ---------------------------------------------------------------------------
+// Reads a 32-bit little-endian integer.
+static auto read_uint32(const char* ptr) -> size_t {
+  auto result = size_t(0);
+  for (auto ix = sizeof(uint32_t); ix > 0; --ix) {
+    result = (result << 8U) | static_cast<uint8_t>(ptr[ix - 1]);
+  }
+  return result;
+}
 
-  {
-    auto gil = pybind11::gil_scoped_release();
-    snappy::RawCompress(slice.ptr, slice.len, buffer, &compressed_len);
+// ---------------------------------------------------------------------------
+// Writes the header of a frame.
+static auto write_frame_header(char* ptr, const uint8_t codec,
+                               const bool native, const size_t size) -> void {
+  ptr[0] = static_cast<char>(codec | kFrameFlag | (native ? kNativeFlag : 0));
+  write_uint32(ptr + 1, size);
+}
+
+// ---------------------------------------------------------------------------
+// Zstandard contexts kept between the calls, the threads of
+// parallel::dispatch being created on each call: a thread takes a context
+// from the pool, or creates one if the pool is empty, and returns it to the
+// pool once its data is processed.
+template <typename T>
+class ZstdContextPool {
+ public:
+  using Pointer = std::unique_ptr<T, size_t (*)(T*)>;
+
+  ZstdContextPool(T* (*create)(), size_t (*release)(T*))
+      : create_(create), release_(release) {}
+
+  // Takes a context from the pool.
+  auto acquire() -> Pointer {
+    {
+      auto lock = std::lock_guard<std::mutex>(mutex_);
+      if (!contexts_.empty()) {
+        auto result = std::move(contexts_.back());
+        contexts_.pop_back();
+        return result;
+      }
+    }
+    auto result = Pointer(create_(), release_);
+    if (!result) {
+      throw std::bad_alloc();
+    }
+    return result;
   }
-  if (_PyBytes_Resize(&result.ptr(), compressed_len + 1) < 0) {
-    throw pybind11::error_already_set();
+
+  // Returns a context to the pool.
+  auto put(Pointer context) -> void {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    contexts_.emplace_back(std::move(context));
   }
+
+ private:
+  T* (*create_)();
+  size_t (*release_)(T*);
+  std::mutex mutex_{};
+  std::vector<Pointer> contexts_{};
+};
+
+static auto compression_contexts =
+    ZstdContextPool<ZSTD_CCtx>(ZSTD_createCCtx, ZSTD_freeCCtx);
+static auto decompression_contexts =
+    ZstdContextPool<ZSTD_DCtx>(ZSTD_createDCtx, ZSTD_freeDCtx);
+
+// ---------------------------------------------------------------------------
+// Compresses the buffer into a frame without calling the Python API, so that
+// the GIL can be released by the caller. The dictionary, if not null, is used
+// by Zstandard.
+static auto compress_frame(const CompressionType compression_type,
+                           const int level, const ZSTD_CDict* dictionary,
+                           const bool native, const char* ptr,
+                           const size_t len) -> std::string {
+  auto result = std::string();
+  auto size = len;
+  switch (compression_type) {
+    case kNoCompression:
+      result.resize(kFrameHeaderSize + len);
+      memcpy(result.data() + kFrameHeaderSize, ptr, len);
+      break;
+    case kSnappyCompression:
+      size = snappy::MaxCompressedLength(len);
+      result.resize(kFrameHeaderSize + size);
+      snappy::RawCompress(ptr, len, result.data() + kFrameHeaderSize, &size);
+      result.resize(kFrameHeaderSize + size);
+      break;
+    case kLZ4Compression: {
+      // LZ4 does not store the size of the uncompressed data, which is
+      // written before the compressed data.
+      if (len > LZ4_MAX_INPUT_SIZE) {
+        throw OperationalError("value too large");
+      }
+      const auto bound = LZ4_compressBound(static_cast<int>(len));
+      result.resize(kFrameHeaderSize + sizeof(uint32_t) + bound);
+      auto* buffer = result.data() + kFrameHeaderSize;
+      write_uint32(buffer, len);
+      buffer += sizeof(uint32_t);
+      const auto compressed =
+          level == 0 ? LZ4_compress_default(ptr, buffer,
+                                            static_cast<int>(len), bound)
+                     : LZ4_compress_HC(ptr, buffer, static_cast<int>(len),
+                                       bound, level);
+      if (compressed <= 0) {
+        throw OperationalError("unable to compress data");
+      }
+      size = sizeof(uint32_t) + static_cast<size_t>(compressed);
+      result.resize(kFrameHeaderSize + size);
+    } break;
+    case kZstdCompression: {
+      const auto bound = ZSTD_compressBound(len);
+      result.resize(kFrameHeaderSize + bound);
+      auto* buffer = result.data() + kFrameHeaderSize;
+      auto context = compression_contexts.acquire();
+      size = dictionary != nullptr
+                 ? ZSTD_compress_usingCDict(context.get(), buffer, bound, ptr,
+                                            len, dictionary)
+                 : ZSTD_compressCCtx(context.get(), buffer, bound, ptr, len,
+                                     level);
+      compression_contexts.put(std::move(context));
+      if (ZSTD_isError(size)) {
+        throw OperationalError(ZSTD_getErrorName(size));
+      }
+      result.resize(kFrameHeaderSize + size);
+    } break;
+    default:
+      throw OperationalError("unknown compression type " +
+                             std::to_string(compression_type));
+  }
+  write_frame_header(result.data(), compression_type, native, size);
   return result;
 }
 
 // ---------------------------------------------------------------------------
-static auto snappy_uncompress(const Slice& slice) -> pybind11::bytes {
-  auto uncompressed_len = size_t(0);
-  if (!snappy::GetUncompressedLength(slice.ptr + 1, slice.len - 1,
-                                     &uncompressed_len)) {
-    throw OperationalError("unable to uncompress data");
+// Appends to "frames" the frames of the record stored in buffer[first, last).
+static auto split_frames(const std::string& buffer, size_t first,
+                         const size_t last, std::vector<Frame>& frames)
+    -> void {
+  const auto* ptr = reinterpret_cast<const uint8_t*>(buffer.data());
+  if (last - first < 2) {
+    throw OperationalError("unable to uncompress value");
   }
-  auto result = pybind11::reinterpret_steal<pybind11::bytes>(
-      PyBytes_FromStringAndSize(nullptr, uncompressed_len + 1));
-  {
-    auto gil = pybind11::gil_scoped_release();
-    snappy::RawUncompress(slice.ptr + 1, static_cast<size_t>(slice.len - 1),
-                          PyBytes_AS_STRING(result.ptr()));
+  if ((ptr[first] & kFrameFlag) == 0) {
+    frames.push_back({ptr[first], false, first + 1, last - first - 1});
+    return;
+  }
+  while (first < last) {
+    if (last - first < kFrameHeaderSize || (ptr[first] & kFrameFlag) == 0) {
+      throw OperationalError("corrupted record");
+    }
+    const auto size = read_uint32(buffer.data() + first + 1);
+    if (size > last - first - kFrameHeaderSize) {
+      throw OperationalError("corrupted record");
+    }
+    frames.push_back(
+        {static_cast<uint8_t>(ptr[first] & ~(kFrameFlag | kNativeFlag)),
+         (ptr[first] & kNativeFlag) != 0, first + kFrameHeaderSize, size});
+    first += kFrameHeaderSize + size;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Returns the keys of the list, checking that they are bytes. The references
+// returned keep the keys alive while the GIL is released, even if another
+// thread modifies the list.
+static auto as_keys(const pybind11::list& items)
+    -> std::vector<pybind11::bytes> {
+  auto result = std::vector<pybind11::bytes>();
+  result.reserve(items.size());
+  for (auto& key : items) {
+    if (!PyBytes_Check(key.ptr())) {
+      throw std::runtime_error("key must be bytes: " +
+                               std::string(pybind11::repr(key)));
+    }
+    result.emplace_back(pybind11::reinterpret_borrow<pybind11::bytes>(key));
   }
   return result;
 }
 
 // ---------------------------------------------------------------------------
-static auto no_uncompress(const Slice& slice) -> pybind11::bytes {
-  auto result = pybind11::reinterpret_steal<pybind11::bytes>(
-      PyBytes_FromStringAndSize(nullptr, slice.len - 1));
-  auto buffer = PyBytes_AS_STRING(result.ptr());
-  memcpy(buffer, slice.ptr + 1, slice.len - 1);
+// The values stored are always lists.
+static auto as_list(const pybind11::object& obj) -> pybind11::list {
+  if (PyList_Check(obj.ptr())) {
+    return pybind11::reinterpret_borrow<pybind11::list>(obj);
+  }
+  auto result = pybind11::list();
+  result.append(obj);
   return result;
 }
 
 // ---------------------------------------------------------------------------
-auto Database::compress(const pybind11::bytes& bytes) const -> pybind11::bytes {
-  auto slice = Slice(bytes);
-  switch (compression_type_) {
+// List of values serialized, or prepared to be serialized, with the GIL held.
+struct Serialized {
+  // Values pickled, if the native codec is not used.
+  pybind11::bytes pickled;
+  // Values prepared to be serialized by the native codec.
+  std::optional<native::Encoder> encoder;
+};
+
+// ---------------------------------------------------------------------------
+// Serializes the values. Pickle is used if the native codec is not selected,
+// or cannot handle the values.
+static auto serialize(const Pickle& pickle,
+                      const SerializationType serialization_type,
+                      const pybind11::object& obj) -> Serialized {
+  auto values = as_list(obj);
+  if (serialization_type == kNativeSerialization) {
+    auto encoder = native::Encoder::prepare(values);
+    if (encoder) {
+      return {pybind11::bytes(), std::move(encoder)};
+    }
+  }
+  return {pickle.dumps(values), std::nullopt};
+}
+
+// ---------------------------------------------------------------------------
+// Compresses the serialized values into a frame. Does not require the GIL.
+static auto encode_frame(const CompressionType compression_type,
+                         const int level, const ZSTD_CDict* dictionary,
+                         const Serialized& value) -> std::string {
+  if (value.encoder) {
+    auto buffer = std::string(value.encoder->size(), '\0');
+    value.encoder->write(buffer.data());
+    return compress_frame(compression_type, level, dictionary, true,
+                          buffer.data(), buffer.size());
+  }
+  auto slice = Slice(value.pickled);
+  return compress_frame(compression_type, level, dictionary, false, slice.ptr,
+                        static_cast<size_t>(slice.len));
+}
+
+// ---------------------------------------------------------------------------
+// Returns the size of the uncompressed data of a frame.
+static auto uncompressed_size(const uint8_t codec, const char* ptr,
+                              const size_t len) -> size_t {
+  switch (codec) {
     case kNoCompression:
-      return no_compress(slice);
-      break;
-    case kSnappyCompression:
-      return snappy_compress(slice);
-      break;
+      return len;
+    case kSnappyCompression: {
+      auto result = size_t(0);
+      if (!snappy::GetUncompressedLength(ptr, len, &result)) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return result;
+    }
+    case kLZ4Compression:
+      if (len < sizeof(uint32_t)) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return read_uint32(ptr);
+    case kZstdCompression: {
+      const auto result = ZSTD_getFrameContentSize(ptr, len);
+      if (result == ZSTD_CONTENTSIZE_UNKNOWN ||
+          result == ZSTD_CONTENTSIZE_ERROR) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return static_cast<size_t>(result);
+    }
   }
   throw OperationalError("unknown compression type " +
-                         std::to_string(compression_type_));
+                         std::to_string(static_cast<int>(codec)));
 }
 
 // ---------------------------------------------------------------------------
-auto Database::uncompress(const pybind11::bytes& bytes) const
-    -> pybind11::bytes {
-  auto slice = Slice(bytes);
-  if (slice.len < 2) {
-    throw OperationalError("unable to uncompress value");
-  }
-  switch (slice.ptr[0]) {
+// Returns the ID of the Zstandard dictionary used to compress the data of a
+// frame, or 0 if the data is not compressed with a dictionary.
+static auto dictionary_id(const uint8_t codec, const char* ptr,
+                          const size_t len) -> unsigned int {
+  return codec == kZstdCompression ? ZSTD_getDictID_fromFrame(ptr, len) : 0;
+}
+
+// ---------------------------------------------------------------------------
+// Uncompresses the data of a frame into "buffer", which holds "size" bytes as
+// returned by uncompressed_size. "dictionary" is the Zstandard dictionary
+// identified by dictionary_id. Does not call the Python API.
+static auto uncompress_frame(const uint8_t codec, const char* ptr,
+                             const size_t len, char* buffer, const size_t size,
+                             const ZSTD_DDict* dictionary) -> void {
+  switch (codec) {
     case kNoCompression:
-      return no_uncompress(slice);
-      break;
+      memcpy(buffer, ptr, len);
+      return;
     case kSnappyCompression:
-      return snappy_uncompress(slice);
-      break;
+      if (!snappy::RawUncompress(ptr, len, buffer)) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return;
+    case kLZ4Compression:
+      if (LZ4_decompress_safe(ptr + sizeof(uint32_t), buffer,
+                              static_cast<int>(len - sizeof(uint32_t)),
+                              static_cast<int>(size)) !=
+          static_cast<int>(size)) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return;
+    case kZstdCompression: {
+      auto context = decompression_contexts.acquire();
+      const auto rc =
+          dictionary != nullptr
+              ? ZSTD_decompress_usingDDict(context.get(), buffer, size, ptr,
+                                           len, dictionary)
+              : ZSTD_decompressDCtx(context.get(), buffer, size, ptr, len);
+      decompression_contexts.put(std::move(context));
+      if (ZSTD_isError(rc) || rc != size) {
+        throw OperationalError("unable to uncompress data");
+      }
+      return;
+    }
   }
   throw OperationalError("unknown compression type " +
-                         std::to_string(static_cast<int>(slice.ptr[0])));
+                         std::to_string(static_cast<int>(codec)));
+}
+
+// ---------------------------------------------------------------------------
+// Consumer of unqlite_kv_fetch_callback appending the data to a std::string.
+static auto append_data(const void* data, const unsigned int len,
+                        void* user_data) -> int {
+  try {
+    static_cast<std::string*>(user_data)->append(
+        static_cast<const char*>(data), len);
+  } catch (std::bad_alloc&) {
+    return UNQLITE_NOMEM;
+  }
+  return UNQLITE_OK;
+}
+
+// ---------------------------------------------------------------------------
+auto Database::fetch(const char* key, const int key_len,
+                     std::string& buffer) const -> bool {
+  // The size and the data of the record are read in a single call.
+  auto rc =
+      unqlite_kv_fetch_callback(handle_, key, key_len, append_data, &buffer);
+  if (rc == UNQLITE_NOTFOUND) {
+    return false;
+  }
+  handle_rc(rc);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Consumer of unqlite_kv_fetch_callback reading the first byte of a record,
+// then aborting the fetch.
+static auto read_header(const void* data, const unsigned int len,
+                        void* user_data) -> int {
+  if (len != 0) {
+    *static_cast<int*>(user_data) = *static_cast<const uint8_t*>(data);
+  }
+  return UNQLITE_ABORT;
+}
+
+// ---------------------------------------------------------------------------
+auto Database::append(const char* key, const int key_len,
+                      const std::string& frame) const -> void {
+  // Only the beginning of the record is read to check its layout.
+  auto header = int(0);
+  auto rc =
+      unqlite_kv_fetch_callback(handle_, key, key_len, read_header, &header);
+  if (rc == UNQLITE_NOTFOUND ||
+      (rc == UNQLITE_ABORT && (header & kFrameFlag) != 0)) {
+    handle_rc(unqlite_kv_append(handle_, key, key_len, frame.data(),
+                                static_cast<unqlite_int64>(frame.size())));
+    return;
+  }
+  if (rc != UNQLITE_ABORT) {
+    handle_rc(rc);
+  }
+
+  // The record written by a previous version is converted into a frame.
+  auto record = std::string();
+  auto frames = std::vector<Frame>();
+  fetch(key, key_len, record);
+  split_frames(record, 0, record.size(), frames);
+  auto buffer = std::string(kFrameHeaderSize, '\0');
+  write_frame_header(buffer.data(), frames[0].codec, false, frames[0].size);
+  buffer.append(record, frames[0].offset, frames[0].size);
+  buffer += frame;
+  handle_rc(unqlite_kv_store(handle_, key, key_len, buffer.data(),
+                             static_cast<unqlite_int64>(buffer.size())));
 }
 
 // ---------------------------------------------------------------------------
 auto Database::setitem(const pybind11::bytes& key,
                        const pybind11::object& obj) const -> void {
-  pybind11::list value;
-  if (PyList_Check(obj.ptr())) {
-    value = obj;
-  } else {
-    value.append(obj);
-  }
-  auto data = compress(pickle_.dumps(value));
+  auto value = serialize(pickle_, serialization_type_, obj);
   auto slice_key = Slice(key);
-  auto slice_data = Slice(data);
+  const auto dictionary = compression_dictionary();
   {
     auto gil = pybind11::gil_scoped_release();
+    auto frame = encode_frame(compression_type_, compression_level_,
+                              dictionary.get(), value);
     handle_rc(unqlite_kv_store(handle_, slice_key.ptr,
-                               static_cast<int>(slice_key.len), slice_data.ptr,
-                               static_cast<unqlite_int64>(slice_data.len)));
+                               static_cast<int>(slice_key.len), frame.data(),
+                               static_cast<unqlite_int64>(frame.size())));
   }
 }
 
 // ---------------------------------------------------------------------------
-auto Database::update(const pybind11::dict& map) const -> void {
+auto Database::update(const pybind11::dict& map, const size_t batch_size,
+                      const size_t num_threads) const -> void {
+  if (batch_size == 0) {
+    throw std::invalid_argument("batch_size must be greater than zero");
+  }
+  auto items = std::vector<std::pair<pybind11::bytes, pybind11::object>>();
+  items.reserve(pybind11::len(map));
   for (auto& item : map) {
     const auto key = item.first;
     if (!PyBytes_Check(item.first.ptr())) {
       throw std::runtime_error("key must be bytes: " +
                                std::string(pybind11::repr(key)));
     }
-    setitem(pybind11::reinterpret_borrow<pybind11::object>(key),
-            pybind11::reinterpret_borrow<pybind11::object>(item.second));
+    items.emplace_back(
+        pybind11::reinterpret_borrow<pybind11::bytes>(key),
+        pybind11::reinterpret_borrow<pybind11::object>(item.second));
   }
-}
+  const auto dictionary = compression_dictionary();
 
-// ---------------------------------------------------------------------------
-auto Database::getitem(const pybind11::bytes& key) const -> pybind11::list {
-  const auto ptr_key = PyBytes_AS_STRING(key.ptr());
-  unqlite_int64 size;
+  for (size_t start = 0; start < items.size(); start += batch_size) {
+    const auto size = std::min(batch_size, items.size() - start);
+
+    // The serialization of the values requires the GIL.
+    auto serialized = std::vector<Serialized>();
+    serialized.reserve(size);
+    for (size_t ix = 0; ix < size; ++ix) {
+      serialized.emplace_back(
+          serialize(pickle_, serialization_type_, items[start + ix].second));
+    }
 
-  auto rc = unqlite_kv_fetch(handle_, ptr_key, -1, nullptr, &size);
-  if (rc == UNQLITE_NOTFOUND) {
-    return pybind11::list();
-  }
-  if (rc != UNQLITE_OK) {
-    handle_rc(rc);
-  }
-  auto data = pybind11::reinterpret_steal<pybind11::bytes>(
-      PyBytes_FromStringAndSize(nullptr, size));
-  if (data.ptr() == nullptr) {
-    throw std::runtime_error("out of memory");
-  }
-  auto buffer = PyBytes_AS_STRING(data.ptr());
-  {
     auto gil = pybind11::gil_scoped_release();
-    handle_rc(unqlite_kv_fetch(handle_, ptr_key, -1, buffer, &size));
+    auto records = std::vector<std::string>(size);
+    parallel::dispatch(
+        [&](const size_t first, const size_t last) {
+          for (auto ix = first; ix < last; ++ix) {
+            records[ix] =
+                encode_frame(compression_type_, compression_level_,
+                             dictionary.get(), serialized[ix]);
+          }
+        },
+        size, num_threads, kMinValuesPerThread);
+
+    // All the records of the batch are written in a single transaction.
+    handle_rc(unqlite_begin(handle_));
+    try {
+      for (size_t ix = 0; ix < size; ++ix) {
+        const auto key = Slice(items[start + ix].first);
+        handle_rc(unqlite_kv_store(handle_, key.ptr, static_cast<int>(key.len),
+                                   records[ix].data(),
+                                   static_cast<unqlite_int64>(
+                                       records[ix].size())));
+      }
+      handle_rc(unqlite_commit(handle_));
+    } catch (...) {
+      unqlite_rollback(handle_);
+      throw;
+    }
   }
-  return pickle_.loads(uncompress(data));
+}
+
+// ---------------------------------------------------------------------------
+auto Database::getitem(const pybind11::bytes& key) const -> pybind11::list {
+  auto keys = pybind11::list();
+  keys.append(key);
+  return values(keys, 1)[0].cast<pybind11::list>();
 }
 
 // ---------------------------------------------------------------------------
 auto Database::extend(const pybind11::dict& map) const -> void {
+  const auto dictionary = compression_dictionary();
   for (auto& item : map) {
-    const auto key = item.first;
     if (!PyBytes_Check(item.first.ptr())) {
       throw std::runtime_error("key must be bytes: " +
-                               std::string(pybind11::repr(key)));
+                               std::string(pybind11::repr(item.first)));
     }
-    auto existing_value =
-        getitem(pybind11::reinterpret_borrow<pybind11::object>(key));
-    if (pybind11::len(existing_value) == 0) {
-      setitem(pybind11::reinterpret_borrow<pybind11::object>(key),
-              pybind11::reinterpret_borrow<pybind11::object>(item.second));
-    } else {
-      if (PyList_Check(item.second.ptr())) {
-        auto cat = pybind11::reinterpret_steal<pybind11::object>(
-            PySequence_InPlaceConcat(existing_value.ptr(), item.second.ptr()));
-        setitem(pybind11::reinterpret_borrow<pybind11::object>(key),
-                pybind11::reinterpret_borrow<pybind11::object>(cat));
-      } else {
-        existing_value.append(item.second);
-        setitem(pybind11::reinterpret_borrow<pybind11::object>(key),
-                pybind11::reinterpret_borrow<pybind11::object>(existing_value));
+    // The reference keeps the key alive if another thread modifies the map
+    // while the GIL is released.
+    const auto key = pybind11::reinterpret_borrow<pybind11::bytes>(item.first);
+    auto value =
+        serialize(pickle_, serialization_type_,
+                  pybind11::reinterpret_borrow<pybind11::object>(item.second));
+    auto slice_key = Slice(key);
+    {
+      // The new values are stored in a frame appended to the record.
+      auto gil = pybind11::gil_scoped_release();
+      append(slice_key.ptr, static_cast<int>(slice_key.len),
+             encode_frame(compression_type_, compression_level_,
+                          dictionary.get(), value));
+    }
+  }
+}
+
+// ---------------------------------------------------------------------------
+auto Database::consolidate(const std::optional<pybind11::list>& keys,
+                           const size_t batch_size,
+                           const size_t num_threads) const -> void {
+  if (batch_size == 0) {
+    throw std::invalid_argument("batch_size must be greater than zero");
+  }
+  // Search for the records made of several frames.
+  auto fragmented = std::vector<pybind11::bytes>();
+  auto record = std::string();
+  auto frames = std::vector<Frame>();
+  for (auto& key : as_keys(keys.has_value() ? keys.value() : this->keys())) {
+    auto slice = Slice(key);
+    record.clear();
+    frames.clear();
+    {
+      auto gil = pybind11::gil_scoped_release();
+      if (fetch(slice.ptr, static_cast<int>(slice.len), record)) {
+        split_frames(record, 0, record.size(), frames);
       }
     }
+    if (frames.size() > 1) {
+      fragmented.emplace_back(std::move(key));
+    }
+  }
+
+  // Their values are rewritten in a single frame.
+  for (size_t start = 0; start < fragmented.size(); start += batch_size) {
+    const auto size = std::min(batch_size, fragmented.size() - start);
+    auto batch = pybind11::list();
+    for (size_t ix = 0; ix < size; ++ix) {
+      batch.append(fragmented[start + ix]);
+    }
+    auto items = values(batch, num_threads);
+    auto map = pybind11::dict();
+    for (size_t ix = 0; ix < size; ++ix) {
+      map[fragmented[start + ix]] = items[ix];
+    }
+    update(map, batch_size, num_threads);
   }
 }
 
 // ---------------------------------------------------------------------------
-auto Database::values(const std::optional<pybind11::list>& keys) const
-    -> pybind11::list {
-  auto result = pybind11::list();
-  for (auto& key : keys.has_value() ? keys.value() : this->keys()) {
-    if (!PyBytes_Check(key.ptr())) {
-      throw std::runtime_error("key must be bytes: " +
-                               std::string(pybind11::repr(key)));
+auto Database::dictionary(const unsigned int id) const -> const ZSTD_DDict* {
+  if (id == 0) {
+    return nullptr;
+  }
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  auto it = dictionaries_.find(id);
+  if (it != dictionaries_.end()) {
+    return it->second.get();
+  }
+  const auto key = kDictionaryKey + std::to_string(id);
+  auto content = std::string();
+  if (!fetch(key.data(), static_cast<int>(key.size()), content)) {
+    throw OperationalError("missing Zstandard dictionary " +
+                           std::to_string(id));
+  }
+  auto result = std::shared_ptr<ZSTD_DDict>(
+      ZSTD_createDDict(content.data(), content.size()), ZSTD_freeDDict);
+  if (!result) {
+    throw OperationalError("invalid Zstandard dictionary " +
+                           std::to_string(id));
+  }
+  dictionaries_.emplace(id, result);
+  return result.get();
+}
+
+// ---------------------------------------------------------------------------
+auto Database::compression_dictionary() const
+    -> std::shared_ptr<ZSTD_CDict> {
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  return dictionary_;
+}
+
+// ---------------------------------------------------------------------------
+auto Database::set_dictionary(const std::string& content) -> void {
+  auto dictionary = std::shared_ptr<ZSTD_CDict>(
+      ZSTD_createCDict(content.data(), content.size(), compression_level_),
+      ZSTD_freeCDict);
+  if (!dictionary) {
+    throw OperationalError("invalid Zstandard dictionary");
+  }
+  // The writers compressing values keep the previous dictionary alive.
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  dictionary_.swap(dictionary);
+}
+
+// ---------------------------------------------------------------------------
+auto Database::train_dictionary(const std::optional<pybind11::list>& keys,
+                                const size_t capacity) -> void {
+  if (compression_type_ != kZstdCompression) {
+    throw ProgrammingError(
+        "a dictionary can only be trained for a database compressed with "
+        "Zstandard");
+  }
+  if (capacity == 0) {
+    throw std::invalid_argument("capacity must be greater than zero");
+  }
+  const auto items = as_keys(keys.has_value() ? keys.value() : this->keys());
+  auto slices = std::vector<Slice>(items.begin(), items.end());
+
+  auto gil = pybind11::gil_scoped_release();
+
+  // The samples are the serialized values stored in the frames of the
+  // records.
+  auto samples = std::string();
+  auto sizes = std::vector<size_t>();
+  auto record = std::string();
+  auto frames = std::vector<Frame>();
+  for (const auto& slice : slices) {
+    record.clear();
+    frames.clear();
+    if (!fetch(slice.ptr, static_cast<int>(slice.len), record)) {
+      continue;
+    }
+    split_frames(record, 0, record.size(), frames);
+    for (const auto& frame : frames) {
+      const auto* ptr = record.data() + frame.offset;
+      const auto size = uncompressed_size(frame.codec, ptr, frame.size);
+      const auto offset = samples.size();
+      samples.resize(offset + size);
+      uncompress_frame(frame.codec, ptr, frame.size, samples.data() + offset,
+                       size,
+                       dictionary(dictionary_id(frame.codec, ptr, frame.size)));
+      sizes.push_back(size);
+    }
+    if (samples.size() >= kMaxSamplesRatio * capacity) {
+      break;
+    }
+  }
+
+  auto content = std::string(capacity, '\0');
+  const auto size =
+      ZDICT_trainFromBuffer(content.data(), capacity, samples.data(),
+                            sizes.data(), static_cast<unsigned>(sizes.size()));
+  if (ZDICT_isError(size)) {
+    throw OperationalError(std::string("unable to train the dictionary: ") +
+                           ZDICT_getErrorName(size));
+  }
+  content.resize(size);
+
+  // The dictionary is stored under its ID, to uncompress the values, and as
+  // the dictionary compressing the new values.
+  const auto key = kDictionaryKey + std::to_string(ZDICT_getDictID(
+                                        content.data(), content.size()));
+  handle_rc(unqlite_begin(handle_));
+  try {
+    handle_rc(unqlite_kv_store(handle_, key.data(),
+                               static_cast<int>(key.size()), content.data(),
+                               static_cast<unqlite_int64>(content.size())));
+    handle_rc(unqlite_kv_store(handle_, kDictionaryKey,
+                               static_cast<int>(kDictionaryKeySize),
+                               content.data(),
+                               static_cast<unqlite_int64>(content.size())));
+    handle_rc(unqlite_commit(handle_));
+  } catch (...) {
+    unqlite_rollback(handle_);
+    throw;
+  }
+  set_dictionary(content);
+}
+
+// ---------------------------------------------------------------------------
+auto Database::values(const std::optional<pybind11::list>& keys,
+                      const size_t num_threads) const -> pybind11::list {
+  const auto items = as_keys(keys.has_value() ? keys.value() : this->keys());
+  auto slices = std::vector<Slice>(items.begin(), items.end());
+  const auto size = slices.size();
+
+  // The records read are stored one after the other in "records". The frames
+  // of the item ix are frames[item_frames[ix], item_frames[ix + 1]), an empty
+  // range denoting a missing key. The pickled frame jx is uncompressed in
+  // uncompressed[offsets[jx], offsets[jx] + sizes[jx]), and the native frame
+  // jx in its own buffer, buffers[jx], which is shared with the arrays
+  // decoded from it.
+  auto records = std::string();
+  auto frames = std::vector<Frame>();
+  auto item_frames = std::vector<size_t>(size + 1, 0);
+  auto uncompressed = std::vector<char>();
+  auto buffers = std::vector<std::unique_ptr<std::vector<char>>>();
+  auto offsets = std::vector<size_t>();
+  auto sizes = std::vector<size_t>();
+  auto decoders = std::vector<native::Decoder>();
+  auto dictionaries = std::vector<const ZSTD_DDict*>();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    for (size_t ix = 0; ix < size; ++ix) {
+      const auto first = records.size();
+      if (fetch(slices[ix].ptr, static_cast<int>(slices[ix].len), records)) {
+        split_frames(records, first, records.size(), frames);
+      }
+      item_frames[ix + 1] = frames.size();
+    }
+    offsets.resize(frames.size() + 1, 0);
+    sizes.resize(frames.size());
+    dictionaries.resize(frames.size());
+    for (size_t jx = 0; jx < frames.size(); ++jx) {
+      const auto& frame = frames[jx];
+      sizes[jx] = uncompressed_size(
+          frame.codec, records.data() + frame.offset, frame.size);
+      dictionaries[jx] = dictionary(dictionary_id(
+          frame.codec, records.data() + frame.offset, frame.size));
+      offsets[jx + 1] = offsets[jx] + (frame.native ? 0 : sizes[jx]);
     }
-    result.append(getitem(pybind11::reinterpret_borrow<pybind11::bytes>(key)));
+    uncompressed.resize(offsets.back());
+    buffers.resize(frames.size());
+    decoders.resize(frames.size());
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          for (auto jx = start; jx < end; ++jx) {
+            const auto& frame = frames[jx];
+            auto* buffer = uncompressed.data() + offsets[jx];
+            if (frame.native) {
+              buffers[jx] = std::make_unique<std::vector<char>>(sizes[jx]);
+              buffer = buffers[jx]->data();
+            }
+            uncompress_frame(frame.codec, records.data() + frame.offset,
+                             frame.size, buffer, sizes[jx], dictionaries[jx]);
+            if (frame.native) {
+              decoders[jx] = native::Decoder(buffer, sizes[jx]);
+            }
+          }
+        },
+        frames.size(), num_threads, kMinValuesPerThread);
+  }
+
+  // Only the creation of the Python objects requires the GIL. The pickled
+  // values are read through memory views, without copy, and the lists stored
+  // in the frames of a record are concatenated.
+  auto result = pybind11::list(size);
+  for (size_t ix = 0; ix < size; ++ix) {
+    auto value = pybind11::list();
+    for (auto jx = item_frames[ix]; jx < item_frames[ix + 1]; ++jx) {
+      auto frame_values = pybind11::object();
+      if (frames[jx].native) {
+        // The arrays decoded are views on the buffer of the frame, which
+        // lives as long as one of them.
+        auto* buffer = buffers[jx]->data();
+        auto owner = pybind11::capsule(buffers[jx].get(), [](void* ptr) {
+          delete reinterpret_cast<std::vector<char>*>(ptr);
+        });
+        buffers[jx].release();
+        frame_values = decoders[jx].values(buffer, owner);
+      } else {
+        auto view = pybind11::reinterpret_steal<pybind11::object>(
+            PyMemoryView_FromMemory(uncompressed.data() + offsets[jx],
+                                    static_cast<Py_ssize_t>(sizes[jx]),
+                                    PyBUF_READ));
+        if (view.ptr() == nullptr) {
+          throw pybind11::error_already_set();
+        }
+        frame_values = pickle_.loads(view);
+      }
+      if (PyList_SetSlice(value.ptr(), PY_SSIZE_T_MAX, PY_SSIZE_T_MAX,
+                          frame_values.ptr()) != 0) {
+        throw pybind11::error_already_set();
+      }
+    }
+    result[ix] = value;
   }
   return result;
 }
 
+// ---------------------------------------------------------------------------
+// Returns true if the key, storing a dictionary, is hidden to the user.
+static auto is_hidden(const char* key, const size_t len) -> bool {
+  return len >= kDictionaryKeySize &&
+         std::memcmp(key, kDictionaryKey, kDictionaryKeySize) == 0;
+}
+
 // ---------------------------------------------------------------------------
 auto Database::keys() const -> pybind11::list {
   int key_len;
@@ -395,7 +1053,10 @@ auto Database::keys() const -> pybind11::list {
           PyBytes_FromStringAndSize(nullptr, key_len));
       handle_rc(unqlite_kv_cursor_key(cursor, PyBytes_AS_STRING(item.ptr()),
                                       &key_len));
-      result.append(item);
+      if (!is_hidden(PyBytes_AS_STRING(item.ptr()),
+                     static_cast<size_t>(key_len))) {
+        result.append(item);
+      }
     }
     unqlite_kv_cursor_release(handle_, cursor);
   } catch (...) {
@@ -408,6 +1069,8 @@ auto Database::keys() const -> pybind11::list {
 // ---------------------------------------------------------------------------
 auto Database::len() const -> size_t {
   auto result = size_t(0);
+  auto key_len = int(0);
+  auto key = std::string();
 
   unqlite_kv_cursor* cursor = nullptr;
   handle_rc(unqlite_kv_cursor_init(handle_, &cursor));
@@ -416,6 +1079,15 @@ auto Database::len() const -> size_t {
     for (unqlite_kv_cursor_first_entry(cursor);
          unqlite_kv_cursor_valid_entry(cursor) != 0;
          unqlite_kv_cursor_next_entry(cursor)) {
+      // Only the keys long enough to be hidden are read.
+      handle_rc(unqlite_kv_cursor_key(cursor, nullptr, &key_len));
+      if (static_cast<size_t>(key_len) >= kDictionaryKeySize) {
+        key.resize(key_len);
+        handle_rc(unqlite_kv_cursor_key(cursor, key.data(), &key_len));
+        if (is_hidden(key.data(), key.size())) {
+          continue;
+        }
+      }
       ++result;
     }
     unqlite_kv_cursor_release(handle_, cursor);
@@ -440,7 +1112,9 @@ auto Database::clear() const -> void {
       handle_rc(unqlite_kv_cursor_key(cursor, nullptr, &key_len));
       auto key = std::string(key_len + 1, '\0');
       handle_rc(unqlite_kv_cursor_key(cursor, key.data(), &key_len));
-      keys.emplace_back(key);
+      if (!is_hidden(key.data(), static_cast<size_t>(key_len))) {
+        keys.emplace_back(key);
+      }
     }
     unqlite_kv_cursor_release(handle_, cursor);
   } catch (...) {
@@ -1,44 +1,82 @@
 #include "geohash/string.hpp"
 
+#include <algorithm>
 #include <array>
+#include <vector>
 
 #include "geohash/base32.hpp"
 #include "geohash/int64.hpp"
+#include "geohash/kernel.hpp"
+#include "geohash/parallel.hpp"
 
 namespace geohash::string {
 
 // Handle encoding/decoding in base32
 static const auto base32 = Base32();
 
+// Number of hashs converted at once by the base32 kernels before being
+// processed by the integer kernels.
+static constexpr size_t kBlockSize = 256;
+
+// Decodes "size" hashs of "count" bytes with the base32 kernel. Throws
+// std::invalid_argument if a hash holds an invalid character or is empty.
+static auto decode_block(const kernel::Kernel& kernel, const char* ptr,
+                         const size_t size, const size_t count,
+                         uint64_t* integers, uint32_t* chars) -> void {
+  if (kernel.decode_base32(ptr, size, count, integers, chars) != size) {
+    throw std::invalid_argument("hash must be a valid GeoHash");
+  }
+  for (size_t ix = 0; ix < size; ++ix) {
+    if (chars[ix] == 0) {
+      throw std::invalid_argument("hash must not be empty");
+    }
+  }
+}
+
+// Calls "worker(start, end, chars)" for each run [start, end) of consecutive
+// hashs of the same length, so that they are decoded by the integer kernels
+// in one call.
+template <typename Worker>
+static auto for_each_run(const uint32_t* chars, const size_t size,
+                         const Worker& worker) -> void {
+  for (size_t ix = 0; ix < size;) {
+    auto jx = ix + 1;
+    while (jx < size && chars[jx] == chars[ix]) {
+      ++jx;
+    }
+    worker(ix, jx, chars[ix]);
+    ix = jx;
+  }
+}
+
 // ---------------------------------------------------------------------------
 auto Array::get_info(const pybind11::array& hashs, const ssize_t ndim)
     -> pybind11::buffer_info {
-  auto info = hashs.request();
   auto dtype = hashs.dtype();
-  switch (ndim) {
-    case 1:
-      if (info.ndim != 1) {
-        throw std::invalid_argument("hashs must be a one-dimensional array");
-      }
-      if (dtype.kind() != 'S') {
-        throw std::invalid_argument("hash must be a string array");
-      }
-      if (info.strides[0] > 12) {
-        throw std::invalid_argument("hash length must be within [1, 12]");
-      }
-      break;
-    default:
-      if (info.ndim != 2) {
-        throw std::invalid_argument("hashs must be a two-dimensional array");
-      }
-      if (info.strides[0] != hashs.shape(1) * info.strides[1] ||
-          dtype.kind() != 'S') {
-        throw std::invalid_argument("hash must be a string array");
-      }
-      if (info.strides[1] > 12) {
-        throw std::invalid_argument("hash length must be within [1, 12]");
-      }
-      break;
+  if (hashs.ndim() != ndim) {
+    throw std::invalid_argument(ndim == 1
+                                    ? "hashs must be a one-dimensional array"
+                                    : "hashs must be a two-dimensional array");
+  }
+  if (dtype.kind() != 'S') {
+    throw std::invalid_argument("hash must be a string array");
+  }
+  const auto chars = dtype.itemsize();
+  if (chars < 1 || chars > 12) {
+    throw std::invalid_argument("hash length must be within [1, 12]");
+  }
+  // The hashs are read one after the other, "chars" bytes each: the views
+  // which are not contiguous, such as reversed or strided views, are copied.
+  // The buffer returned keeps the copy alive.
+  auto array = pybind11::array::ensure(hashs, pybind11::array::c_style);
+  if (!array) {
+    throw pybind11::error_already_set();
+  }
+  auto info = array.request();
+  // The strides of the dimensions of length 1 are arbitrary.
+  info.strides.back() = chars;
+  if (ndim == 2) {
+    info.strides[0] = info.shape[1] * chars;
   }
   return info;
 }
@@ -51,17 +89,69 @@ auto encode(const Point& point, char* const buffer, const uint32_t precision)
 
 // ---------------------------------------------------------------------------
 auto encode(const Eigen::Ref<const Eigen::Matrix<Point, -1, 1>>& points,
-            const uint32_t precision) -> pybind11::array {
+            const uint32_t precision, const size_t num_threads)
+    -> pybind11::array {
   auto array = Array(points.size(), precision);
   auto buffer = array.buffer();
+  const auto& kernel = kernel::current();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto integers = std::array<uint64_t, kBlockSize>();
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            kernel.encode_points(points.data() + ix, size, precision * 5,
+                                 integers.data());
+            kernel.encode_base32(integers.data(), size, precision, precision,
+                                 buffer + ix * precision);
+          }
+        },
+        static_cast<size_t>(points.size()), num_threads);
+  }
+  return array.pyarray();
+}
 
-  for (Eigen::Index ix = 0; ix < points.size(); ++ix) {
-    encode(points(ix), buffer, precision);
-    buffer += precision;
+// ---------------------------------------------------------------------------
+template <typename T>
+auto encode(const int64::Coordinates<T>& lng, const int64::Coordinates<T>& lat,
+            const uint32_t precision, const size_t num_threads)
+    -> pybind11::array {
+  // Number of points encoded at once by the integer encoder.
+  constexpr auto block_size = Eigen::Index(4096);
+
+  if (lng.size() != lat.size()) {
+    throw std::invalid_argument("lng and lat must have the same size");
+  }
+  auto array = Array(lng.size(), precision);
+  auto buffer = array.buffer();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          for (auto ix = static_cast<Eigen::Index>(start);
+               ix < static_cast<Eigen::Index>(end); ix += block_size) {
+            auto size =
+                std::min(block_size, static_cast<Eigen::Index>(end) - ix);
+            auto hashs = int64::encode<T>(lng.segment(ix, size),
+                                          lat.segment(ix, size),
+                                          precision * 5, 1);
+            kernel::current().encode_base32(hashs.data(), size, precision,
+                                            precision, buffer + ix * precision);
+          }
+        },
+        static_cast<size_t>(lng.size()), num_threads);
   }
   return array.pyarray();
 }
 
+template auto encode<double>(const int64::Coordinates<double>&,
+                             const int64::Coordinates<double>&, uint32_t,
+                             size_t) -> pybind11::array;
+template auto encode<float>(const int64::Coordinates<float>&,
+                            const int64::Coordinates<float>&, uint32_t, size_t)
+    -> pybind11::array;
+
 // ---------------------------------------------------------------------------
 inline auto decode_bounding_box(const char* const hash, const size_t count,
                                 uint32_t* precision = nullptr) -> Box {
@@ -79,145 +169,552 @@ auto bounding_box(const char* const hash, const size_t count) -> Box {
   return decode_bounding_box(hash, count);
 }
 
+// ---------------------------------------------------------------------------
+auto bounding_box(const pybind11::array& hashs,
+                  int64::MutableCoordinates<double> lng_min,
+                  int64::MutableCoordinates<double> lat_min,
+                  int64::MutableCoordinates<double> lng_max,
+                  int64::MutableCoordinates<double> lat_max,
+                  const size_t num_threads) -> void {
+  auto info = Array::get_info(hashs, 1);
+  auto count = info.strides[0];
+  if (lng_min.size() != info.shape[0] || lat_min.size() != info.shape[0] ||
+      lng_max.size() != info.shape[0] || lat_max.size() != info.shape[0]) {
+    throw std::invalid_argument(
+        "lng_min, lat_min, lng_max, lat_max and hashs must have the same "
+        "size");
+  }
+  auto ptr = static_cast<char*>(info.ptr);
+  const auto& kernel = kernel::current();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto integers = std::array<uint64_t, kBlockSize>();
+          auto chars = std::array<uint32_t, kBlockSize>();
+          auto buffer = std::array<std::array<double, kBlockSize>, 4>();
+
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            decode_block(kernel, ptr + ix * count, size, count,
+                         integers.data(), chars.data());
+            for_each_run(chars.data(), size,
+                         [&](const size_t first, const size_t last,
+                             const uint32_t length) {
+                           kernel.decode_boxes(
+                               integers.data() + first, last - first,
+                               kernel::decoder(5 * length),
+                               buffer[0].data() + first,
+                               buffer[1].data() + first,
+                               buffer[2].data() + first,
+                               buffer[3].data() + first);
+                         });
+            for (size_t jx = 0; jx < size; ++jx) {
+              lng_min(ix + jx) = buffer[0][jx];
+              lat_min(ix + jx) = buffer[1][jx];
+              lng_max(ix + jx) = buffer[2][jx];
+              lat_max(ix + jx) = buffer[3][jx];
+            }
+          }
+        },
+        static_cast<size_t>(info.shape[0]), num_threads);
+  }
+}
+
 // ---------------------------------------------------------------------------
 auto decode(const char* const hash, const size_t count, const bool round)
     -> Point {
-  auto bbox = bounding_box(hash, count);
-  return round ? bbox.round() : bbox.center();
+  uint64_t integer_encoded;
+  uint32_t chars;
+  std::tie(integer_encoded, chars) = base32.decode(hash, count);
+  return int64::decode(integer_encoded, 5 * chars, round);
 }
 
 // ---------------------------------------------------------------------------
-auto decode(const pybind11::array& hashs, const bool round)
-    -> Eigen::Matrix<Point, -1, 1> {
+// Decodes "size" hashs of "count" bytes into points with the base32 and the
+// integer kernels.
+static auto decode_points(const kernel::Kernel& kernel, const char* ptr,
+                          const size_t size, const size_t count,
+                          const bool round, Point* points) -> void {
+  auto integers = std::array<uint64_t, kBlockSize>();
+  auto chars = std::array<uint32_t, kBlockSize>();
+  decode_block(kernel, ptr, size, count, integers.data(), chars.data());
+  for_each_run(chars.data(), size,
+               [&](const size_t first, const size_t last,
+                   const uint32_t length) {
+                 kernel.decode_points(integers.data() + first, last - first,
+                                      kernel::decoder(5 * length), round,
+                                      points + first);
+               });
+}
+
+// ---------------------------------------------------------------------------
+auto decode(const pybind11::array& hashs, const bool round,
+            const size_t num_threads) -> Eigen::Matrix<Point, -1, 1> {
   auto info = Array::get_info(hashs, 1);
   auto count = info.strides[0];
   auto result = Eigen::Matrix<Point, -1, 1>(info.shape[0]);
   auto ptr = static_cast<char*>(info.ptr);
-  for (auto ix = 0LL; ix < info.shape[0]; ++ix) {
-    result(ix) = decode(ptr, count, round);
-    ptr += count;
+  const auto& kernel = kernel::current();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            decode_points(kernel, ptr + ix * count,
+                          std::min(kBlockSize, end - ix), count, round,
+                          result.data() + ix);
+          }
+        },
+        static_cast<size_t>(info.shape[0]), num_threads);
+  }
+  return result;
+}
+
+// ---------------------------------------------------------------------------
+template <typename T>
+auto decode(const pybind11::array& hashs, const bool round,
+            int64::MutableCoordinates<T> lng, int64::MutableCoordinates<T> lat,
+            const size_t num_threads) -> void {
+  auto info = Array::get_info(hashs, 1);
+  auto count = info.strides[0];
+  if (lng.size() != info.shape[0] || lat.size() != info.shape[0]) {
+    throw std::invalid_argument(
+        "lng, lat and hashs must have the same size");
+  }
+  auto ptr = static_cast<char*>(info.ptr);
+  const auto& kernel = kernel::current();
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto points = std::array<Point, kBlockSize>();
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            decode_points(kernel, ptr + ix * count, size, count, round,
+                          points.data());
+            for (size_t jx = 0; jx < size; ++jx) {
+              lng(ix + jx) = static_cast<T>(points[jx].lng);
+              lat(ix + jx) = static_cast<T>(points[jx].lat);
+            }
+          }
+        },
+        static_cast<size_t>(info.shape[0]), num_threads);
+  }
+}
+
+template auto decode<double>(const pybind11::array&, bool,
+                             int64::MutableCoordinates<double>,
+                             int64::MutableCoordinates<double>, size_t)
+    -> void;
+template auto decode<float>(const pybind11::array&, bool,
+                            int64::MutableCoordinates<float>,
+                            int64::MutableCoordinates<float>, size_t) -> void;
+
+// ---------------------------------------------------------------------------
+auto from_int64(const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+                const uint32_t bits, const uint32_t chars,
+                const size_t num_threads) -> pybind11::array {
+  if (bits < 1 || bits > 64) {
+    throw std::invalid_argument("bits must be within [1, 64]");
+  }
+  if (5 * chars > bits) {
+    throw std::invalid_argument(
+        "precision must not exceed the number of characters encoded by "
+        "bits");
+  }
+  // Number of bits removed to get the codes of the parent cells.
+  const auto shift = bits - 5 * chars;
+  auto array = Array(hashs.size(), chars);
+  auto buffer = array.buffer();
+  {
+    const auto& kernel = kernel::current();
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto codes = std::array<uint64_t, kBlockSize>();
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            const auto* integers = hashs.data() + ix;
+            if (shift != 0) {
+              for (size_t jx = 0; jx < size; ++jx) {
+                codes[jx] = integers[jx] >> shift;
+              }
+              integers = codes.data();
+            }
+            kernel.encode_base32(integers, size, chars, chars,
+                                 buffer + ix * chars);
+          }
+        },
+        static_cast<size_t>(hashs.size()), num_threads);
+  }
+  return array.pyarray();
+}
+
+// ---------------------------------------------------------------------------
+auto to_int64(const pybind11::array& hashs,
+              const std::optional<uint32_t>& bits, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  auto info = Array::get_info(hashs, 1);
+  auto count = static_cast<size_t>(info.strides[0]);
+  auto precision = bits.value_or(static_cast<uint32_t>(5 * count));
+  if (precision < 1 || precision > 5 * count) {
+    throw std::invalid_argument("bits must be within [1, " +
+                                std::to_string(5 * count) + "]");
+  }
+  auto ptr = static_cast<char*>(info.ptr);
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(info.shape[0]);
+  {
+    const auto& kernel = kernel::current();
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto chars = std::array<uint32_t, kBlockSize>();
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            auto integers = result.data() + ix;
+            decode_block(kernel, ptr + ix * count, size, count, integers,
+                         chars.data());
+            for (size_t jx = 0; jx < size; ++jx) {
+              if (5 * chars[jx] < precision) {
+                throw std::invalid_argument(
+                    "hash is too short for the precision requested");
+              }
+              integers[jx] >>= 5 * chars[jx] - precision;
+            }
+          }
+        },
+        static_cast<size_t>(info.shape[0]), num_threads);
   }
   return result;
 }
 
+// ---------------------------------------------------------------------------
+// Encodes the integer geohash into a vector of strings of "precision"
+// characters.
+static auto encode_integers(
+    const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& integers,
+    const uint32_t precision) -> pybind11::array {
+  auto array = Array(integers.size(), precision);
+  kernel::current().encode_base32(integers.data(),
+                                  static_cast<size_t>(integers.size()),
+                                  precision, precision, array.buffer());
+  return array.pyarray();
+}
+
 // ---------------------------------------------------------------------------
 auto neighbors(const char* const hash, const size_t count) -> pybind11::array {
   uint64_t integer_encoded;
   uint32_t precision;
   std::tie(integer_encoded, precision) = base32.decode(hash, count);
 
-  const auto integers = int64::neighbors(integer_encoded, precision * 5);
-  auto array = Array(integers.size(), precision);
-  auto buffer = array.buffer();
+  return encode_integers(int64::neighbors(integer_encoded, precision * 5),
+                         precision);
+}
 
-  for (auto ix = 0; ix < integers.size(); ++ix) {
-    base32.encode(integers(ix), buffer, precision);
-    buffer += precision;
+// ---------------------------------------------------------------------------
+auto neighbors(const pybind11::array& hashs, const bool unique,
+               const size_t num_threads) -> pybind11::array {
+  auto info = Array::get_info(hashs, 1);
+  auto count = static_cast<size_t>(info.strides[0]);
+  auto rows = static_cast<size_t>(info.shape[0]);
+  auto ptr = static_cast<char*>(info.ptr);
+  const auto& kernel = kernel::current();
+
+  // Computes the neighbors of the hashs [start, end) by blocks and calls
+  // "worker(first, size, codes, chars)" for each block: the index of its
+  // first hash, its number of hashs, their neighbors, 8 per hash, and their
+  // number of characters.
+  auto for_each_block = [&](const size_t start, const size_t end,
+                            const auto& worker) -> void {
+    auto integers = std::array<uint64_t, kBlockSize>();
+    auto chars = std::array<uint32_t, kBlockSize>();
+    auto codes = std::array<uint64_t, kBlockSize * 8>();
+    for (auto ix = start; ix < end; ix += kBlockSize) {
+      auto size = std::min(kBlockSize, end - ix);
+      decode_block(kernel, ptr + ix * count, size, count, integers.data(),
+                   chars.data());
+      for (size_t jx = 0; jx < size; ++jx) {
+        Eigen::Map<Eigen::Matrix<uint64_t, 8, 1>>(codes.data() + jx * 8) =
+            int64::neighbors(integers[jx], 5 * chars[jx]);
+      }
+      worker(ix, size, codes.data(), chars.data());
+    }
+  };
+
+  if (!unique) {
+    auto array = Array(rows * 8, static_cast<uint32_t>(count));
+    auto buffer = array.buffer();
+    {
+      auto gil = pybind11::gil_scoped_release();
+      parallel::dispatch(
+          [&](const size_t start, const size_t end) {
+            for_each_block(
+                start, end,
+                [&](const size_t first, const size_t size,
+                    const uint64_t* codes, const uint32_t* chars) {
+                  // The neighbors of the hashs of the same length are
+                  // encoded by the kernel in one call.
+                  for_each_run(chars, size,
+                               [&](const size_t begin, const size_t last,
+                                   const uint32_t length) {
+                                 kernel.encode_base32(
+                                     codes + begin * 8, (last - begin) * 8,
+                                     length, count,
+                                     buffer + (first + begin) * 8 * count);
+                               });
+                });
+          },
+          rows, num_threads, parallel::kMinChunkSize / 8);
+    }
+    return array.pyarray(8);
+  }
+
+  // The neighbors are stored as keys sorted as the strings: the bits of the
+  // hash aligned on the most significant bit followed by the number of
+  // characters in the 4 lower bits.
+  auto keys = std::vector<uint64_t>(rows * 8);
+  {
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          for_each_block(start, end,
+                         [&](const size_t first, const size_t size,
+                             const uint64_t* codes, const uint32_t* chars) {
+                           auto* it = keys.data() + first * 8;
+                           for (size_t ix = 0; ix < size * 8; ++ix) {
+                             const auto length = chars[ix / 8];
+                             *(it++) = (codes[ix] << (64 - 5 * length)) |
+                                       length;
+                           }
+                         });
+        },
+        rows, num_threads, parallel::kMinChunkSize / 8);
+    std::sort(keys.begin(), keys.end());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  }
+
+  auto array = Array(keys.size(), static_cast<uint32_t>(count));
+  auto buffer = array.buffer();
+  for (const auto key : keys) {
+    const auto length = static_cast<uint32_t>(key & 0xFU);
+    base32.encode(key >> (64 - 5 * length), buffer, length);
+    buffer += count;
   }
   return array.pyarray();
 }
 
 // ---------------------------------------------------------------------------
-auto bounding_boxes(const std::optional<Box>& box, const uint32_t precision)
+auto k_ring(const char* const hash, const size_t count, const uint32_t k)
     -> pybind11::array {
-  size_t lat_step;
-  size_t lng_step;
-  size_t size = 0;
-  uint64_t hash_sw;
-
-  // Number of bits
-  auto bits = precision * 5;
+  uint64_t integer_encoded;
+  uint32_t precision;
+  std::tie(integer_encoded, precision) = base32.decode(hash, count);
 
-  // Calculation of the number of elements constituting the grid
-  const auto boxes = box.value_or(Box({-180, -90}, {180, 90})).split();
-  for (const auto& item : boxes) {
-    std::tie(hash_sw, lng_step, lat_step) = int64::grid_properties(item, bits);
-    size += lat_step * lng_step;
-  }
+  return encode_integers(int64::k_ring(integer_encoded, precision * 5, k),
+                         precision);
+}
 
-  // Grid resolution in degrees
-  const auto lng_lat_err = int64::error_with_precision(bits);
+// ---------------------------------------------------------------------------
+// Encodes the cells [start, start + count) of the grid into "buffer" using
+// "num_threads" threads. The codes are stepped by blocks and encoded in base32
+// in the same pass.
+static auto encode_grid(const int64::Grid& grid, const size_t start,
+                        const size_t count, const uint32_t precision,
+                        char* buffer, const size_t num_threads) -> void {
+  const auto& kernel = kernel::current();
+  parallel::dispatch(
+      [&](const size_t first, const size_t last) {
+        auto codes = std::array<uint64_t, kBlockSize>();
+        for (auto ix = first; ix < last; ix += kBlockSize) {
+          auto size = std::min(kBlockSize, last - ix);
+          grid.codes(start + ix, size, codes.data(), 1);
+          kernel.encode_base32(codes.data(), size, precision, precision,
+                               buffer + ix * precision);
+        }
+      },
+      count, num_threads);
+}
 
-  // Allocation of the vector storing the different codes of the matrix created
-  auto result = Array(size, precision);
-  auto buffer = result.buffer();
+// ---------------------------------------------------------------------------
+auto Cover::next(const size_t num_threads) -> pybind11::array {
+  size_t start;
+  size_t end;
+  std::tie(start, end) = advance();
+  auto result = Array(end - start, chars_);
+  {
+    auto gil = pybind11::gil_scoped_release();
+    encode_grid(grid_, start, end - start, chars_, result.buffer(),
+                num_threads);
+  }
+  return result.pyarray();
+}
 
-  for (const auto& item : boxes) {
-    std::tie(hash_sw, lng_step, lat_step) = int64::grid_properties(item, bits);
-    const auto point_sw = int64::decode(hash_sw, bits, true);
+// ---------------------------------------------------------------------------
+auto bounding_boxes(const std::optional<Box>& box, const uint32_t precision,
+                    const size_t num_threads) -> pybind11::array {
+  const auto grid = int64::Grid(box, precision * 5);
+  auto result = Array(grid.size(), precision);
+  {
+    auto gil = pybind11::gil_scoped_release();
+    encode_grid(grid, 0, grid.size(), precision, result.buffer(),
+                num_threads);
+  }
+  return result.pyarray();
+}
 
-    for (size_t lat = 0; lat < lat_step; ++lat) {
-      const auto lat_shift = lat * std::get<1>(lng_lat_err);
+// ---------------------------------------------------------------------------
+auto polygon_cover(const Polygon& polygon, const uint32_t precision,
+                   const size_t num_threads)
+    -> std::tuple<pybind11::array, pybind11::array> {
+  Eigen::Matrix<uint64_t, -1, 1> inside;
+  Eigen::Matrix<uint64_t, -1, 1> boundary;
+  {
+    auto gil = pybind11::gil_scoped_release();
+    std::tie(inside, boundary) =
+        int64::polygon_cover(polygon, precision * 5, num_threads);
+  }
+  return std::make_tuple(encode_integers(inside, precision),
+                         encode_integers(boundary, precision));
+}
 
-      for (size_t lng = 0; lng < lng_step; ++lng) {
-        const auto lng_shift = lng * std::get<0>(lng_lat_err);
+// ---------------------------------------------------------------------------
+auto bounding_boxes(const Polygon& polygon, const uint32_t precision,
+                    const size_t num_threads) -> pybind11::array {
+  Eigen::Matrix<uint64_t, -1, 1> codes;
+  {
+    auto gil = pybind11::gil_scoped_release();
+    codes = int64::bounding_boxes(polygon, precision * 5, num_threads);
+  }
+  return encode_integers(codes, precision);
+}
 
-        base32.encode(
-            int64::encode({point_sw.lng + lng_shift, point_sw.lat + lat_shift},
-                          bits),
-            buffer, precision);
-        buffer += precision;
-      }
-    }
+// ---------------------------------------------------------------------------
+auto circle_cover(const Point& center, const double radius,
+                  const uint32_t precision, const size_t num_threads)
+    -> std::tuple<pybind11::array, Eigen::Matrix<double, -1, 1>,
+                  Eigen::Matrix<double, -1, 1>> {
+  int64::CircleCover cover;
+  {
+    auto gil = pybind11::gil_scoped_release();
+    cover = int64::circle_cover(center, radius, precision * 5, num_threads);
   }
-  return result.pyarray();
+  return std::make_tuple(encode_integers(std::get<0>(cover), precision),
+                         std::move(std::get<1>(cover)),
+                         std::move(std::get<2>(cover)));
 }
 
-auto where(const pybind11::array& hashs)
-    -> std::map<std::string, std::tuple<std::tuple<int64_t, int64_t>,
-                                        std::tuple<int64_t, int64_t>>> {
-  // Index shifts of neighboring pixels
-  static const auto shift_row =
-      std::array<int64_t, 8>{-1, -1, -1, 0, 1, 0, 1, 1};
-  static const auto shift_col =
-      std::array<int64_t, 8>{-1, 1, 0, -1, -1, 1, 0, 1};
+// ---------------------------------------------------------------------------
+// Decodes the GeoHash of any length into their integer codes and their
+// precisions in bits.
+static auto decode_cells(const pybind11::array& hashs)
+    -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                  Eigen::Matrix<uint32_t, -1, 1>> {
+  auto info = Array::get_info(hashs, 1);
+  auto count = info.strides[0];
+  auto ptr = static_cast<char*>(info.ptr);
 
   auto result =
-      std::map<std::string, std::tuple<std::tuple<int64_t, int64_t>,
-                                       std::tuple<int64_t, int64_t>>>();
+      std::make_tuple(Eigen::Matrix<uint64_t, -1, 1>(info.shape[0]),
+                      Eigen::Matrix<uint32_t, -1, 1>(info.shape[0]));
+  auto& precisions = std::get<1>(result);
+  decode_block(kernel::current(), ptr, info.shape[0], count,
+               std::get<0>(result).data(), precisions.data());
+  precisions *= 5U;
+  return result;
+}
 
+// ---------------------------------------------------------------------------
+auto compact(const pybind11::array& hashs) -> pybind11::array {
+  Eigen::Matrix<uint64_t, -1, 1> codes;
+  Eigen::Matrix<uint32_t, -1, 1> precisions;
+  std::tie(codes, precisions) = decode_cells(hashs);
+  {
+    auto gil = pybind11::gil_scoped_release();
+    std::tie(codes, precisions) = int64::compact(codes, precisions);
+  }
+  // The shorter GeoHash are padded with null characters.
+  const auto chars = precisions.size() == 0 ? 1 : precisions.maxCoeff() / 5;
+  auto array = Array(codes.size(), chars);
+  auto buffer = array.buffer();
+  for (auto ix = 0; ix < codes.size(); ++ix) {
+    base32.encode(codes(ix), buffer, precisions(ix) / 5);
+    buffer += chars;
+  }
+  return array.pyarray();
+}
+
+// ---------------------------------------------------------------------------
+auto expand(const pybind11::array& hashs, const uint32_t chars,
+            const size_t num_threads) -> pybind11::array {
+  Eigen::Matrix<uint64_t, -1, 1> codes;
+  Eigen::Matrix<uint32_t, -1, 1> precisions;
+  std::tie(codes, precisions) = decode_cells(hashs);
+  {
+    auto gil = pybind11::gil_scoped_release();
+    codes = int64::expand(codes, precisions, chars * 5, num_threads);
+  }
+  return encode_integers(codes, chars);
+}
+
+// ---------------------------------------------------------------------------
+auto where(const pybind11::array& hashs, const size_t num_threads)
+    -> std::tuple<pybind11::array, Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<int64_t, -1, 1>, Eigen::Matrix<int64_t, -1, 1>,
+                  Eigen::Matrix<int64_t, -1, 1>> {
   auto info = Array::get_info(hashs, 2);
   auto rows = info.shape[0];
   auto cols = info.shape[1];
-  auto chars = info.strides[1];
+  auto chars = static_cast<size_t>(info.strides[1]);
   auto ptr = static_cast<char*>(info.ptr);
-  std::string current_code;
-  std::string neighboring_code;
-
-  assert(chars <= 12);
-
-  for (int64_t ix = 0; ix < rows; ++ix) {
-    for (int64_t jx = 0; jx < cols; ++jx) {
-      current_code = std::string(ptr + (ix * cols + jx) * chars, chars);
-
-      auto it = result.find(current_code);
-      if (it == result.end()) {
-        result.emplace(std::make_pair(
-            current_code,
-            std::make_tuple(std::make_tuple(ix, ix), std::make_tuple(jx, jx))));
-        continue;
-      }
-
-      for (int64_t kx = 0; kx < 8; ++kx) {
-        const auto i = ix + shift_row[kx];
-        const auto j = jx + shift_col[kx];
-
-        if (i >= 0 && i < rows && j >= 0 && j < cols) {
-          neighboring_code = std::string(ptr + (i * cols + j) * chars, chars);
-          if (current_code == neighboring_code) {
-            auto& first = std::get<0>(it->second);
-            std::get<0>(first) = std::min(std::get<0>(first), i);
-            std::get<1>(first) = std::max(std::get<1>(first), i);
 
-            auto& second = std::get<1>(it->second);
-            std::get<0>(second) = std::min(std::get<0>(second), j);
-            std::get<1>(second) = std::max(std::get<1>(second), j);
+  // The hashs are decoded into integer keys: the bits of the hash aligned on
+  // the most significant bit followed by the number of characters in the 4
+  // lower bits. The keys of hashs of different lengths are distinct, and
+  // their order is the order of the strings.
+  auto keys = Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>(rows, cols);
+  int64::Extents extents;
+  {
+    const auto& kernel = kernel::current();
+    auto gil = pybind11::gil_scoped_release();
+    parallel::dispatch(
+        [&](const size_t start, const size_t end) {
+          auto data = keys.data();
+          auto counts = std::array<uint32_t, kBlockSize>();
+          for (auto ix = start; ix < end; ix += kBlockSize) {
+            auto size = std::min(kBlockSize, end - ix);
+            if (kernel.decode_base32(ptr + ix * chars, size, chars, data + ix,
+                                     counts.data()) != size) {
+              throw std::invalid_argument("hash must be a valid GeoHash");
+            }
+            for (size_t jx = 0; jx < size; ++jx) {
+              const auto count = counts[jx];
+              data[ix + jx] =
+                  count == 0
+                      ? 0
+                      : (data[ix + jx] << (64 - 5 * count)) | count;
+            }
           }
-        }
-      }
+        },
+        static_cast<size_t>(rows * cols), num_threads);
+    extents = int64::where(keys, num_threads);
+  }
+
+  // Only the distinct keys are converted back to strings.
+  const auto& codes = std::get<0>(extents);
+  auto array = Array(codes.size(), chars);
+  auto buffer = array.buffer();
+  for (auto ix = 0; ix < codes.size(); ++ix) {
+    const auto count = static_cast<uint32_t>(codes(ix) & 0xFU);
+    if (count != 0) {
+      base32.encode(codes(ix) >> (64 - 5 * count), buffer, count);
     }
+    buffer += chars;
   }
-  return result;
+  return std::make_tuple(array.pyarray(), std::move(std::get<1>(extents)),
+                         std::move(std::get<2>(extents)),
+                         std::move(std::get<3>(extents)),
+                         std::move(std::get<4>(extents)));
 }
 
 }  // namespace geohash::string
@@ -7,6 +7,8 @@
 
 #include <sstream>
 
+#include "geohash/filter.hpp"
+
 namespace py = pybind11;
 
 void init_geometry(py::module& m) {
@@ -86,6 +88,43 @@ Args:
           "Returns the box covering the whole earth.")
       .def("contains", &geohash::Box::contains, py::arg("point"),
            "Returns true if the geographic point is within the box")
+      .def(
+          "contains",
+          [](const geohash::Box& self,
+             const Eigen::Ref<const Eigen::Matrix<geohash::Point, -1, 1>>&
+                 points,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return geohash::filter::contains(self, points, num_threads);
+          },
+          py::arg("points"), py::arg("num_threads") = 0,
+          "Returns the mask of the points within the box. num_threads is the "
+          "number of threads used, 0 selects the default number of threads.")
+      .def(
+          "contains",
+          [](const geohash::Box& self,
+             const geohash::int64::Coordinates<double>& lng,
+             const geohash::int64::Coordinates<double>& lat,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return geohash::filter::contains<double>(self, lng, lat,
+                                                     num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("num_threads") = 0,
+          "Returns the mask of the positions, defined by separate arrays of "
+          "longitudes and latitudes, within the box. num_threads is the "
+          "number of threads used, 0 selects the default number of threads.")
+      .def(
+          "contains",
+          [](const geohash::Box& self,
+             const geohash::int64::Coordinates<float>& lng,
+             const geohash::int64::Coordinates<float>& lat,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return geohash::filter::contains<float>(self, lng, lat,
+                                                    num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("num_threads") = 0)
       .def("wkt",
            [](const geohash::Box& self) -> std::string {
              auto ss = std::stringstream();
@@ -172,4 +211,60 @@ Args:
             return polygon;
           },
           py::arg("wkt"), "Returns the WKT representation of the Polygon");
+
+  py::class_<geohash::filter::PreparedPolygon>(
+      m, "PreparedPolygon",
+      "Polygon prepared to test whether many points are inside it. Its edges "
+      "are indexed once by bands of latitude.")
+      .def(py::init<geohash::Polygon>(), py::arg("polygon"), R"(
+Constructor indexing the edges of the polygon
+
+Args:
+  polygon (geohash.Polygon): the polygon to prepare
+)")
+      .def("envelope", &geohash::filter::PreparedPolygon::envelope,
+           "Returns the envelope of the polygon.")
+      .def(
+          "contains",
+          [](const geohash::filter::PreparedPolygon& self,
+             const geohash::Point& point) -> bool {
+            return self.contains(point);
+          },
+          py::arg("point"), "Returns true if the point is inside the polygon")
+      .def(
+          "contains",
+          [](const geohash::filter::PreparedPolygon& self,
+             const Eigen::Ref<const Eigen::Matrix<geohash::Point, -1, 1>>&
+                 points,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return self.contains(points, num_threads);
+          },
+          py::arg("points"), py::arg("num_threads") = 0,
+          "Returns the mask of the points inside the polygon. num_threads is "
+          "the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "contains",
+          [](const geohash::filter::PreparedPolygon& self,
+             const geohash::int64::Coordinates<double>& lng,
+             const geohash::int64::Coordinates<double>& lat,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return self.contains<double>(lng, lat, num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("num_threads") = 0,
+          "Returns the mask of the positions, defined by separate arrays of "
+          "longitudes and latitudes, inside the polygon. num_threads is the "
+          "number of threads used, 0 selects the default number of threads.")
+      .def(
+          "contains",
+          [](const geohash::filter::PreparedPolygon& self,
+             const geohash::int64::Coordinates<float>& lng,
+             const geohash::int64::Coordinates<float>& lat,
+             const size_t num_threads) -> Eigen::Matrix<bool, -1, 1> {
+            auto gil = py::gil_scoped_release();
+            return self.contains<float>(lng, lat, num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("num_threads") = 0);
 }
@@ -16,6 +16,21 @@ inline auto check_range(uint32_t precision) -> void {
   }
 }
 
+// Returns the codes of the next chunk of the cover. The cursor is moved
+// holding the GIL, and released while the codes are written.
+inline auto next_chunk(geohash::int64::Cover& self, const size_t num_threads)
+    -> Eigen::Matrix<uint64_t, -1, 1> {
+  size_t start;
+  size_t end;
+  std::tie(start, end) = self.advance();
+  auto result = Eigen::Matrix<uint64_t, -1, 1>(end - start);
+  {
+    auto gil = py::gil_scoped_release();
+    self.grid().codes(start, end - start, result.data(), num_threads);
+  }
+  return result;
+}
+
 void init_int64(py::module& m) {
   m.def(
        "error",
@@ -40,12 +55,47 @@ void init_int64(py::module& m) {
           "encode",
           [](const Eigen::Ref<const Eigen::Matrix<geohash::Point, -1, 1>>&
                  points,
-             const uint32_t precision) -> Eigen::Matrix<uint64_t, -1, 1> {
+             const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
             check_range(precision);
-            return geohash::int64::encode(points, precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::encode(points, precision, num_threads);
           },
           py::arg("points"), py::arg("precision") = 64,
-          "Encode points into geohash with the given precision")
+          py::arg("num_threads") = 0,
+          "Encode points into geohash with the given precision. num_threads "
+          "is the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "encode",
+          [](const geohash::int64::Coordinates<double>& lng,
+             const geohash::int64::Coordinates<double>& lat,
+             const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::encode<double>(lng, lat, precision,
+                                                  num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Encode the points defined by separate arrays of longitudes and "
+          "latitudes into geohash with the given precision. num_threads is "
+          "the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "encode",
+          [](const geohash::int64::Coordinates<float>& lng,
+             const geohash::int64::Coordinates<float>& lat,
+             const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::encode<float>(lng, lat, precision,
+                                                 num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0)
       .def(
           "decode",
           [](const uint64_t hash, const uint32_t precision,
@@ -60,15 +110,73 @@ void init_int64(py::module& m) {
       .def(
           "decode",
           [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
-             const uint32_t precision,
-             const bool round) -> Eigen::Matrix<geohash::Point, -1, 1> {
+             const uint32_t precision, const bool round,
+             const size_t num_threads) -> Eigen::Matrix<geohash::Point, -1, 1> {
             check_range(precision);
-            return geohash::int64::decode(hashs, precision, round);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::decode(hashs, precision, round,
+                                          num_threads);
           },
           py::arg("hashs"), py::arg("precision") = 64, py::arg("round") = false,
+          py::arg("num_threads") = 0,
           "Decode hashs into a spherical equatorial points with the given bit "
           "depth. If round is true, the coordinates of the points will be "
-          "rounded to the accuracy defined by the GeoHash.")
+          "rounded to the accuracy defined by the GeoHash. num_threads is the "
+          "number of threads used, 0 selects the default number of threads.")
+      .def(
+          "decode_lnglat",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const bool round,
+             const size_t num_threads) -> py::tuple {
+            check_range(precision);
+            auto lng = Eigen::VectorXd(hashs.size());
+            auto lat = Eigen::VectorXd(hashs.size());
+            {
+              auto gil = py::gil_scoped_release();
+              geohash::int64::decode<double>(hashs, precision, round, lng, lat,
+                                             num_threads);
+            }
+            return py::make_tuple(std::move(lng), std::move(lat));
+          },
+          py::arg("hashs"), py::arg("precision") = 64, py::arg("round") = false,
+          py::arg("num_threads") = 0,
+          "Decode hashs into separate arrays of longitudes and latitudes with "
+          "the given bit depth. If round is true, the coordinates of the "
+          "points will be rounded to the accuracy defined by the GeoHash. "
+          "num_threads is the number of threads used, 0 selects the default "
+          "number of threads.")
+      .def(
+          "decode_lnglat",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             geohash::int64::MutableCoordinates<double> lng,
+             geohash::int64::MutableCoordinates<double> lat,
+             const uint32_t precision, const bool round,
+             const size_t num_threads) -> void {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            geohash::int64::decode<double>(hashs, precision, round, lng, lat,
+                                           num_threads);
+          },
+          py::arg("hashs"), py::arg("lng"), py::arg("lat"),
+          py::arg("precision") = 64, py::arg("round") = false,
+          py::arg("num_threads") = 0,
+          "Decode hashs into the arrays of longitudes and latitudes provided "
+          "by the caller.")
+      .def(
+          "decode_lnglat",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             geohash::int64::MutableCoordinates<float> lng,
+             geohash::int64::MutableCoordinates<float> lat,
+             const uint32_t precision, const bool round,
+             const size_t num_threads) -> void {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            geohash::int64::decode<float>(hashs, precision, round, lng, lat,
+                                          num_threads);
+          },
+          py::arg("hashs"), py::arg("lng"), py::arg("lat"),
+          py::arg("precision") = 64, py::arg("round") = false,
+          py::arg("num_threads") = 0)
       .def(
           "bounding_box",
           [](const uint64_t hash, const uint32_t precision) -> geohash::Box {
@@ -78,16 +186,185 @@ void init_int64(py::module& m) {
           py::arg("hash"), py::arg("precision") = 64,
           "Returns the region encoded by the integer geohash with the "
           "specified precision.")
+      .def(
+          "bounding_box",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const size_t num_threads) -> py::tuple {
+            check_range(precision);
+            auto lng_min = Eigen::VectorXd(hashs.size());
+            auto lat_min = Eigen::VectorXd(hashs.size());
+            auto lng_max = Eigen::VectorXd(hashs.size());
+            auto lat_max = Eigen::VectorXd(hashs.size());
+            {
+              auto gil = py::gil_scoped_release();
+              geohash::int64::bounding_box(hashs, precision, lng_min, lat_min,
+                                           lng_max, lat_max, num_threads);
+            }
+            return py::make_tuple(std::move(lng_min), std::move(lat_min),
+                                  std::move(lng_max), std::move(lat_max));
+          },
+          py::arg("hashs"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Returns the regions encoded by the integer geohashs with the "
+          "specified precision as four arrays: lng_min, lat_min, lng_max and "
+          "lat_max. num_threads is the number of threads used, 0 selects the "
+          "default number of threads.")
+      .def(
+          "bounding_box",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             geohash::int64::MutableCoordinates<double> lng_min,
+             geohash::int64::MutableCoordinates<double> lat_min,
+             geohash::int64::MutableCoordinates<double> lng_max,
+             geohash::int64::MutableCoordinates<double> lat_max,
+             const uint32_t precision, const size_t num_threads) -> void {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            geohash::int64::bounding_box(hashs, precision, lng_min, lat_min,
+                                         lng_max, lat_max, num_threads);
+          },
+          py::arg("hashs"), py::arg("lng_min"), py::arg("lat_min"),
+          py::arg("lng_max"), py::arg("lat_max"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Writes the regions encoded by the integer geohashs into the arrays "
+          "provided by the caller.")
       .def(
           "bounding_boxes",
-          [](const std::optional<geohash::Box>& box,
-             const uint32_t precision) -> Eigen::Matrix<uint64_t, -1, 1> {
+          [](const std::optional<geohash::Box>& box, const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
             check_range(precision);
-            return geohash::int64::bounding_boxes(box, precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::bounding_boxes(box, precision, num_threads);
           },
           py::arg("box") = py::none(), py::arg("precision") = 5,
+          py::arg("num_threads") = 0,
           "Returns the region encoded by the integer geohash with the "
           "specified precision.")
+      .def(
+          "bounding_boxes",
+          [](const geohash::Polygon& polygon, const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::bounding_boxes(polygon, precision,
+                                                  num_threads);
+          },
+          py::arg("polygon"), py::arg("precision") = 5,
+          py::arg("num_threads") = 0,
+          "Returns the sorted integer geohash of the cells intersecting the "
+          "polygon with the specified precision.")
+      .def(
+          "polygon_cover",
+          [](const geohash::Polygon& polygon, const uint32_t precision,
+             const size_t num_threads)
+              -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                            Eigen::Matrix<uint64_t, -1, 1>> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::polygon_cover(polygon, precision,
+                                                 num_threads);
+          },
+          py::arg("polygon"), py::arg("precision") = 5,
+          py::arg("num_threads") = 0,
+          "Returns the sorted integer geohash of the cells within the polygon "
+          "and of the cells crossing its boundary. Only the cells crossed by "
+          "the edges of the polygon are refined, from a coarse precision to "
+          "the requested precision. The edges are straight lines in the "
+          "longitude/latitude plane: ValueError is raised if one of them "
+          "crosses the antimeridian, spanning more than 180 degrees of "
+          "longitude. num_threads is the number of threads used, 0 selects "
+          "the default number of threads.")
+      .def(
+          "circle_cover",
+          [](const geohash::Point& center, const double radius,
+             const uint32_t precision,
+             const size_t num_threads) -> geohash::int64::CircleCover {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::circle_cover(center, radius, precision,
+                                                num_threads);
+          },
+          py::arg("center"), py::arg("radius"), py::arg("precision") = 5,
+          py::arg("num_threads") = 0,
+          "Returns the integer geohash of the cells within radius meters of "
+          "the center, sorted by increasing distance, and the minimum and "
+          "maximum great-circle distances, in meters, between the center and "
+          "each cell. The distances are computed with the haversine formula "
+          "on a sphere of the mean Earth radius. num_threads is the number "
+          "of threads used, 0 selects the default number of threads.")
+      .def(
+          "range_cover",
+          [](const std::optional<geohash::Box>& box, const uint32_t precision,
+             const size_t max_ranges)
+              -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::range_cover(box, precision, max_ranges);
+          },
+          py::arg("box") = py::none(), py::arg("precision") = 5,
+          py::arg("max_ranges") = 0,
+          "Returns the sorted intervals [start, end) of the codes covering "
+          "the box, one interval per row. If max_ranges is not zero, the "
+          "closest intervals are merged until at most max_ranges remain.")
+      .def(
+          "range_cover",
+          [](const geohash::Polygon& polygon, const uint32_t precision,
+             const size_t max_ranges, const size_t num_threads)
+              -> Eigen::Matrix<uint64_t, -1, 2, Eigen::RowMajor> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::range_cover(polygon, precision, max_ranges,
+                                               num_threads);
+          },
+          py::arg("polygon"), py::arg("precision") = 5,
+          py::arg("max_ranges") = 0, py::arg("num_threads") = 0,
+          "Returns the sorted intervals [start, end) of the codes of the "
+          "cells intersecting the polygon, one interval per row. If "
+          "max_ranges is not zero, the closest intervals are merged until at "
+          "most max_ranges remain. num_threads is the number of threads "
+          "used, 0 selects the default number of threads.")
+      .def(
+          "compact",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision)
+              -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                            Eigen::Matrix<uint32_t, -1, 1>> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::compact(hashs, precision);
+          },
+          py::arg("hashs"), py::arg("precision") = 64,
+          "Replaces recursively the complete groups of 32 sibling cells by "
+          "their parent, five bits coarser, and returns the codes and the "
+          "precisions of the mixed-precision cover sorted along the Z-order "
+          "curve.")
+      .def(
+          "compact",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions)
+              -> std::tuple<Eigen::Matrix<uint64_t, -1, 1>,
+                            Eigen::Matrix<uint32_t, -1, 1>> {
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::compact(hashs, precisions);
+          },
+          py::arg("hashs"), py::arg("precisions"),
+          "Compacts a mixed-precision cover. The cells contained in another "
+          "cell are removed.")
+      .def(
+          "expand",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const Eigen::Ref<const Eigen::Matrix<uint32_t, -1, 1>>& precisions,
+             const uint32_t precision,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::expand(hashs, precisions, precision,
+                                          num_threads);
+          },
+          py::arg("hashs"), py::arg("precisions"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Returns the codes at the given precision of all the cells covered "
+          "by a mixed-precision cover. num_threads is the number of threads "
+          "used, 0 selects the default number of threads.")
       .def(
           "neighbors",
           [](const uint64_t hash,
@@ -98,6 +375,49 @@ void init_int64(py::module& m) {
           py::arg("box"), py::arg("precision") = 64,
           "Returns all neighbors hash clockwise from north around northwest "
           "at the given precision.")
+      .def(
+          "neighbors",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const size_t num_threads)
+              -> Eigen::Matrix<uint64_t, -1, 8, Eigen::RowMajor> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::neighbors(hashs, precision, num_threads);
+          },
+          py::arg("hashs"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Returns the neighbors of each hash, one row per hash, clockwise "
+          "from north around northwest at the given precision. num_threads "
+          "is the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "k_ring",
+          [](const uint64_t hash, const uint32_t k,
+             const uint32_t precision) -> Eigen::Matrix<uint64_t, -1, 1> {
+            check_range(precision);
+            return geohash::int64::k_ring(hash, precision, k);
+          },
+          py::arg("hash"), py::arg("k") = 1, py::arg("precision") = 64,
+          "Returns all the hash within the Chebyshev distance k of hash: the "
+          "hash itself followed by the rings of distance 1 to k, each one "
+          "clockwise from north. k must not exceed the number of columns of "
+          "the grid at the given precision.")
+      .def(
+          "k_ring",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t k, const uint32_t precision,
+             const size_t num_threads)
+              -> Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::k_ring(hashs, precision, k, num_threads);
+          },
+          py::arg("hashs"), py::arg("k") = 1, py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Returns the hash within the Chebyshev distance k of each hash, one "
+          "row per hash. k must not exceed the number of columns of the grid "
+          "at the given precision. num_threads is the number of threads "
+          "used, 0 selects the default number of threads.")
       .def(
           "grid_properties",
           [](const geohash::Box& box,
@@ -109,19 +429,149 @@ void init_int64(py::module& m) {
           "Returns the property of the grid covering the given box: geohash of "
           "the minimum corner point, number of boxes in longitudes and "
           "latitudes.")
+      .def(
+          "argsort",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const size_t num_threads)
+              -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                            Eigen::Matrix<uint64_t, -1, 1>> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::argsort(hashs, precision, num_threads);
+          },
+          py::arg("hashs"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Sorts the codes along the Z-order curve with a parallel radix "
+          "sort and returns the permutation sorting them and the sorted "
+          "codes. The sort is stable. num_threads is the number of threads "
+          "used, 0 selects the default number of threads.")
+      .def(
+          "argsort",
+          [](const geohash::int64::Coordinates<double>& lng,
+             const geohash::int64::Coordinates<double>& lat,
+             const uint32_t precision, const size_t num_threads)
+              -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                            Eigen::Matrix<uint64_t, -1, 1>> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::argsort<double>(lng, lat, precision,
+                                                   num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0,
+          "Encodes the points defined by separate arrays of longitudes and "
+          "latitudes and sorts them along the Z-order curve in the same "
+          "pass. Returns the permutation sorting the points and their sorted "
+          "codes. num_threads is the number of threads used, 0 selects the "
+          "default number of threads.")
+      .def(
+          "argsort",
+          [](const geohash::int64::Coordinates<float>& lng,
+             const geohash::int64::Coordinates<float>& lat,
+             const uint32_t precision, const size_t num_threads)
+              -> std::tuple<Eigen::Matrix<int64_t, -1, 1>,
+                            Eigen::Matrix<uint64_t, -1, 1>> {
+            check_range(precision);
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::argsort<float>(lng, lat, precision,
+                                                  num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 64,
+          py::arg("num_threads") = 0)
+      .def(
+          "permute",
+          [](py::array& values,
+             const Eigen::Ref<const Eigen::Matrix<int64_t, -1, 1>>& permutation,
+             const size_t num_threads) -> void {
+            auto info = values.request(true);
+            if (info.ndim == 0) {
+              throw std::invalid_argument("values must not be a scalar");
+            }
+            // The items permuted are the rows of the array, which must be
+            // contiguous.
+            auto item_size = static_cast<size_t>(info.itemsize);
+            for (auto ix = info.ndim - 1; ix > 0; --ix) {
+              if (info.strides[ix] != static_cast<ssize_t>(item_size)) {
+                throw std::invalid_argument(
+                    "the rows of values must be contiguous");
+              }
+              item_size *= static_cast<size_t>(info.shape[ix]);
+            }
+            auto gil = py::gil_scoped_release();
+            geohash::int64::permute(static_cast<char*>(info.ptr),
+                                    static_cast<size_t>(info.shape[0]),
+                                    item_size, info.strides[0], permutation,
+                                    num_threads);
+          },
+          py::arg("values"), py::arg("permutation"),
+          py::arg("num_threads") = 0,
+          "Reorders in place the items of the array along its first axis so "
+          "that the item i becomes the item permutation[i], like "
+          "values[permutation]. num_threads is the number of threads used, 0 "
+          "selects the default number of threads.")
       .def(
           "where",
-          // We want to return an associative dictionary between bytes and
-          // tuples and not str and tuples.
-          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, -1>>& hash)
-              -> py::dict {
-            auto result = py::dict();
-            for (auto&& item : geohash::int64::where(hash)) {
-              auto key = py::int_(item.first);
-              result[key] = py::cast(item.second);
+          [](const Eigen::Ref<
+                 const Eigen::Matrix<uint64_t, -1, -1, Eigen::RowMajor>>& hash,
+             const size_t num_threads) -> geohash::int64::Extents {
+            auto gil = py::gil_scoped_release();
+            return geohash::int64::where(hash, num_threads);
+          },
+          py::arg("hash"), py::arg("num_threads") = 0,
+          "Returns the distinct codes of the grid, sorted, and the first and "
+          "last rows and the first and last columns of the pixels holding "
+          "each of them: (codes, row_min, row_max, col_min, col_max). "
+          "num_threads is the number of threads used, 0 selects the default "
+          "number of threads.");
+
+  py::class_<geohash::int64::Cover>(
+      m, "Cover",
+      "Iterates over the integer geohash covering a box, in row order, by "
+      "chunks of a fixed size without materializing the whole grid.")
+      .def(py::init([](const std::optional<geohash::Box>& box,
+                       const uint32_t precision, const size_t chunk_size) {
+             check_range(precision);
+             return geohash::int64::Cover(box, precision, chunk_size);
+           }),
+           py::arg("box") = py::none(), py::arg("precision") = 5,
+           py::arg("chunk_size") = 1048576,
+           R"(Constructor
+
+Args:
+    box (geohash.Box, optional): the box to cover. Defaults to the whole
+        Earth.
+    precision (int): the precision of the geohash.
+    chunk_size (int): the number of geohash returned at each iteration.
+)")
+      .def("__len__", &geohash::int64::Cover::size,
+           "Returns the number of geohash covering the box.")
+      .def_property_readonly("chunk_size", &geohash::int64::Cover::chunk_size,
+                             "Number of geohash returned at each iteration")
+      .def_property("cursor", &geohash::int64::Cover::cursor,
+                    &geohash::int64::Cover::seek,
+                    "Index of the first geohash of the next chunk. Setting "
+                    "it resumes the iteration from this geohash.")
+      .def("__iter__",
+           [](geohash::int64::Cover& self) -> geohash::int64::Cover& {
+             return self;
+           })
+      .def(
+          "__next__",
+          [](geohash::int64::Cover& self) -> Eigen::Matrix<uint64_t, -1, 1> {
+            auto result = next_chunk(self, 0);
+            if (result.size() == 0) {
+              throw py::stop_iteration();
             }
             return result;
+          })
+      .def(
+          "next",
+          [](geohash::int64::Cover& self,
+             const size_t num_threads) -> Eigen::Matrix<uint64_t, -1, 1> {
+            return next_chunk(self, num_threads);
           },
-          py::arg("hash"),
-          "Returns the start and end indexes of the different GeoHash boxes.");
+          py::arg("num_threads") = 0,
+          "Returns the geohash of the next chunk, or an empty array if all "
+          "the geohash have been returned. num_threads is the number of "
+          "threads used, 0 selects the default number of threads.");
 }
\ No newline at end of file
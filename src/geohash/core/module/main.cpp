@@ -1,4 +1,8 @@
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
+
+#include "geohash/kernel.hpp"
+#include "geohash/parallel.hpp"
 
 namespace py = pybind11;
 
@@ -14,6 +18,35 @@ PYBIND11_MODULE(core, m) {
   auto storage = m.def_submodule("storage", "Storage support");
   auto unqlite = storage.def_submodule("unqlite", "NoSQL Database Engine");
 
+  m.def("get_num_threads", &geohash::parallel::get_num_threads,
+        "Returns the number of threads used by default by the functions "
+        "processing arrays.")
+      .def("set_num_threads", &geohash::parallel::set_num_threads,
+           py::arg("num_threads"),
+           "Sets the number of threads used by default by the functions "
+           "processing arrays. If num_threads is 0, the number of concurrent "
+           "threads supported by the CPU is used.")
+      .def(
+          "kernel",
+          []() -> std::string { return geohash::kernel::current().name; },
+          "Returns the name of the kernel used to encode and decode the "
+          "GeoHash.")
+      .def(
+          "kernels",
+          []() -> std::vector<std::string> {
+            auto result = std::vector<std::string>();
+            for (const auto* item : geohash::kernel::available()) {
+              result.emplace_back(item->name);
+            }
+            return result;
+          },
+          "Returns the names of the kernels supported by the CPU.")
+      .def("set_kernel", &geohash::kernel::select, py::arg("name"),
+           "Selects the kernel used to encode and decode the GeoHash. By "
+           "default, the fastest kernel is selected when the module is "
+           "loaded, unless the environment variable GEOHASH_KERNEL names the "
+           "kernel to use.");
+
   init_geometry(m);
   init_int64(int64);
   init_string(string);
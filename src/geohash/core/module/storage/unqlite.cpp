@@ -17,14 +17,26 @@ void init_store_unqlite(py::module& m) {
   py::enum_<store::CompressionType>(m, "CompressionType")
       .value("none", store::kNoCompression, "No commpression")
       .value("snappy", store::kSnappyCompression,
-             "Compress values with Snappy");
+             "Compress values with Snappy")
+      .value("lz4", store::kLZ4Compression, "Compress values with LZ4")
+      .value("zstd", store::kZstdCompression,
+             "Compress values with Zstandard");
+
+  py::enum_<store::SerializationType>(m, "SerializationType")
+      .value("pickle", store::kPickleSerialization,
+             "Serialize values with pickle")
+      .value("native", store::kNativeSerialization,
+             "Serialize numpy arrays, and tuples of numpy arrays, natively. "
+             "Other values are pickled");
 
   py::class_<store::Database, std::shared_ptr<store::Database>>(
       m, "Database", "Key/Value store")
       .def(py::init<std::string, const std::optional<std::string>&,
-                    store::CompressionType>(),
+                    store::CompressionType, store::SerializationType, int>(),
            py::arg("name"), py::arg("mode") = py::none(),
            py::arg("compression_type") = store::kSnappyCompression,
+           py::arg("serialization_type") = store::kPickleSerialization,
+           py::arg("compression_level") = 0,
            R"(Opening a database
 
 Args:
@@ -47,6 +59,15 @@ Args:
      compression_mode (CompressionMode, optional): Type of compression used
           to compress values stored into the database. Only has an effect for
           new data written in the database.
+     serialization_type (SerializationType, optional): Serialization of
+          the values stored into the database. With ``native``, lists of
+          numpy arrays, or of tuples of numpy arrays, are stored without
+          pickle and read as arrays viewing the data read, without copy.
+          Only has an effect for new data written in the database.
+     compression_level (int, optional): Compression level used by LZ4, from
+          1 to 12, or by Zstandard, up to 22, the negative levels being the
+          fastest. Default to 0, which selects the default level of the
+          algorithm.
 )")
       .def(py::pickle(
           [](const store::Database& self) -> py::tuple {
@@ -63,6 +84,22 @@ Args:
       .def("__contains__", &store::Database::contains, py::arg("key"))
       .def("error_log", &store::Database::error_log,
            "Reads the contents of the database error log")
+      .def("train_dictionary", &store::Database::train_dictionary,
+           py::arg("keys") = py::none(), py::arg("capacity") = 112640,
+           R"(Train a Zstandard dictionary from the values stored in the
+database.
+
+The dictionary is stored in the database and used to compress the values
+written afterwards with Zstandard, which improves the compression of small
+values. The values compressed with the previous dictionaries remain readable.
+The database must be compressed with Zstandard.
+
+Args:
+     keys (list, optional): keys of the values used to train the
+          dictionary. Defaults to all the keys of the database.
+     capacity (int, optional): maximum size of the dictionary in bytes.
+          Defaults to 112640.
+)")
       .def("commit", &store::Database::commit,
            "Commit all changes to the database.")
       .def("rollback", &store::Database::rollback,
@@ -72,10 +109,53 @@ Args:
       .def("keys", &store::Database::keys,
            "Return a list containing all the keys from the database.")
       .def("update", &store::Database::update, py::arg("map"),
-           "Update the database with the key/value pairs from map, overwriting "
-           "existing keys.")
+           py::arg("batch_size") = 16384, py::arg("num_threads") = 0,
+           R"(Update the database with the key/value pairs from map, overwriting
+existing keys.
+
+Args:
+     map (dict): key/value pairs to store.
+     batch_size (int, optional): number of values serialized, compressed and
+          written in a single transaction. Defaults to 16384.
+     num_threads (int, optional): number of threads used to compress the
+          values. Defaults to the number of threads set for the library.
+
+Note:
+     Each batch is committed once written, with the changes of the database
+     not yet committed: a later call to rollback does not undo them. If an
+     error occurs, the current batch is rolled back but the batches already
+     committed remain written.
+)")
       .def("extend", &store::Database::extend, py::arg("map"),
-           "Extend or create the database with the key/value pairs from map")
+           "Extend or create the database with the key/value pairs from map. "
+           "The new values are appended to the records without rewriting "
+           "them.")
+      .def("consolidate", &store::Database::consolidate,
+           py::arg("keys") = py::none(), py::arg("batch_size") = 16384,
+           py::arg("num_threads") = 0,
+           R"(Rewrite the records extended several times in a single block.
+
+Args:
+     keys (list, optional): keys to consolidate. Defaults to all the keys of
+          the database.
+     batch_size (int, optional): number of values written in a single
+          transaction. Defaults to 16384.
+     num_threads (int, optional): number of threads used to compress the
+          values. Defaults to the number of threads set for the library.
+
+Note:
+     Like update, each batch is committed once written and a failure leaves
+     the batches already committed written.
+)")
       .def("values", &store::Database::values, py::arg("keys") = py::none(),
-           "Read all values from the database for the keys provided");
+           py::arg("num_threads") = 0,
+           R"(Read all values from the database for the keys provided
+
+Args:
+     keys (list, optional): keys to read. Defaults to all the keys of the
+          database. An empty list is returned for the keys not in the
+          database.
+     num_threads (int, optional): number of threads used to uncompress the
+          values. Defaults to the number of threads set for the library.
+)");
 }
\ No newline at end of file
@@ -54,12 +54,44 @@ void init_string(py::module& m) {
           "encode",
           [](const Eigen::Ref<const Eigen::Matrix<geohash::Point, -1, 1>>&
                  points,
-             const uint32_t precision) -> pybind11::array {
+             const uint32_t precision,
+             const size_t num_threads) -> pybind11::array {
             check_range(precision);
-            return geohash::string::encode(points, precision);
+            return geohash::string::encode(points, precision, num_threads);
           },
           py::arg("points"), py::arg("precision") = 12,
-          "Encode points into geohash with the given precision")
+          py::arg("num_threads") = 0,
+          "Encode points into geohash with the given precision. num_threads "
+          "is the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "encode",
+          [](const geohash::int64::Coordinates<double>& lng,
+             const geohash::int64::Coordinates<double>& lat,
+             const uint32_t precision,
+             const size_t num_threads) -> pybind11::array {
+            check_range(precision);
+            return geohash::string::encode<double>(lng, lat, precision,
+                                                   num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 12,
+          py::arg("num_threads") = 0,
+          "Encode the points defined by separate arrays of longitudes and "
+          "latitudes into geohash with the given precision. num_threads is "
+          "the number of threads used, 0 selects the default number of "
+          "threads.")
+      .def(
+          "encode",
+          [](const geohash::int64::Coordinates<float>& lng,
+             const geohash::int64::Coordinates<float>& lat,
+             const uint32_t precision,
+             const size_t num_threads) -> pybind11::array {
+            check_range(precision);
+            return geohash::string::encode<float>(lng, lat, precision,
+                                                  num_threads);
+          },
+          py::arg("lng"), py::arg("lat"), py::arg("precision") = 12,
+          py::arg("num_threads") = 0)
       .def(
           "decode",
           [](const py::str& hash, const bool round) -> geohash::Point {
@@ -73,14 +105,56 @@ void init_string(py::module& m) {
           "defined by the GeoHash.")
       .def(
           "decode",
-          [](const pybind11::array& hashs,
-             const bool round) -> Eigen::Matrix<geohash::Point, -1, 1> {
-            return geohash::string::decode(hashs, round);
+          [](const pybind11::array& hashs, const bool round,
+             const size_t num_threads) -> Eigen::Matrix<geohash::Point, -1, 1> {
+            return geohash::string::decode(hashs, round, num_threads);
           },
           py::arg("hashs"), py::arg("round") = false,
+          py::arg("num_threads") = 0,
           "Decode hashs into a spherical equatorial points. If round is true, "
           "the coordinates of the points will be rounded to the accuracy "
-          "defined by the GeoHash.")
+          "defined by the GeoHash. num_threads is the number of threads used, "
+          "0 selects the default number of threads.")
+      .def(
+          "decode_lnglat",
+          [](const pybind11::array& hashs, const bool round,
+             const size_t num_threads) -> py::tuple {
+            auto lng = Eigen::VectorXd(hashs.size());
+            auto lat = Eigen::VectorXd(hashs.size());
+            geohash::string::decode<double>(hashs, round, lng, lat,
+                                            num_threads);
+            return py::make_tuple(std::move(lng), std::move(lat));
+          },
+          py::arg("hashs"), py::arg("round") = false,
+          py::arg("num_threads") = 0,
+          "Decode hashs into separate arrays of longitudes and latitudes. If "
+          "round is true, the coordinates of the points will be rounded to "
+          "the accuracy defined by the GeoHash. num_threads is the number of "
+          "threads used, 0 selects the default number of threads.")
+      .def(
+          "decode_lnglat",
+          [](const pybind11::array& hashs,
+             geohash::int64::MutableCoordinates<double> lng,
+             geohash::int64::MutableCoordinates<double> lat, const bool round,
+             const size_t num_threads) -> void {
+            geohash::string::decode<double>(hashs, round, lng, lat,
+                                            num_threads);
+          },
+          py::arg("hashs"), py::arg("lng"), py::arg("lat"),
+          py::arg("round") = false, py::arg("num_threads") = 0,
+          "Decode hashs into the arrays of longitudes and latitudes provided "
+          "by the caller.")
+      .def(
+          "decode_lnglat",
+          [](const pybind11::array& hashs,
+             geohash::int64::MutableCoordinates<float> lng,
+             geohash::int64::MutableCoordinates<float> lat, const bool round,
+             const size_t num_threads) -> void {
+            geohash::string::decode<float>(hashs, round, lng, lat,
+                                           num_threads);
+          },
+          py::arg("hashs"), py::arg("lng"), py::arg("lat"),
+          py::arg("round") = false, py::arg("num_threads") = 0)
       .def(
           "bounding_box",
           [](const py::str& hash) -> geohash::Box {
@@ -89,16 +163,130 @@ void init_string(py::module& m) {
                                                  buffer.length());
           },
           py::arg("hash"), "Returns the region encoded by the geohash.")
+      .def(
+          "bounding_box",
+          [](const pybind11::array& hashs,
+             const size_t num_threads) -> py::tuple {
+            auto lng_min = Eigen::VectorXd(hashs.size());
+            auto lat_min = Eigen::VectorXd(hashs.size());
+            auto lng_max = Eigen::VectorXd(hashs.size());
+            auto lat_max = Eigen::VectorXd(hashs.size());
+            geohash::string::bounding_box(hashs, lng_min, lat_min, lng_max,
+                                          lat_max, num_threads);
+            return py::make_tuple(std::move(lng_min), std::move(lat_min),
+                                  std::move(lng_max), std::move(lat_max));
+          },
+          py::arg("hashs"), py::arg("num_threads") = 0,
+          "Returns the regions encoded by the geohashs as four arrays: "
+          "lng_min, lat_min, lng_max and lat_max. num_threads is the number "
+          "of threads used, 0 selects the default number of threads.")
+      .def(
+          "bounding_box",
+          [](const pybind11::array& hashs,
+             geohash::int64::MutableCoordinates<double> lng_min,
+             geohash::int64::MutableCoordinates<double> lat_min,
+             geohash::int64::MutableCoordinates<double> lng_max,
+             geohash::int64::MutableCoordinates<double> lat_max,
+             const size_t num_threads) -> void {
+            geohash::string::bounding_box(hashs, lng_min, lat_min, lng_max,
+                                          lat_max, num_threads);
+          },
+          py::arg("hashs"), py::arg("lng_min"), py::arg("lat_min"),
+          py::arg("lng_max"), py::arg("lat_max"), py::arg("num_threads") = 0,
+          "Writes the regions encoded by the geohashs into the arrays "
+          "provided by the caller.")
       .def(
           "bounding_boxes",
-          [](const std::optional<geohash::Box>& box,
-             const uint32_t precision) -> py::array {
+          [](const std::optional<geohash::Box>& box, const uint32_t precision,
+             const size_t num_threads) -> py::array {
             check_range(precision);
-            return geohash::string::bounding_boxes(box, precision);
+            return geohash::string::bounding_boxes(box, precision, num_threads);
           },
           py::arg("box") = py::none(), py::arg("precision") = 1,
+          py::arg("num_threads") = 0,
           "Returns the region encoded by the geohash with the specified "
           "precision.")
+      .def(
+          "bounding_boxes",
+          [](const geohash::Polygon& polygon, const uint32_t precision,
+             const size_t num_threads) -> py::array {
+            check_range(precision);
+            return geohash::string::bounding_boxes(polygon, precision,
+                                                   num_threads);
+          },
+          py::arg("polygon"), py::arg("precision") = 1,
+          py::arg("num_threads") = 0,
+          "Returns the sorted geohash of the cells intersecting the polygon "
+          "with the specified precision.")
+      .def(
+          "polygon_cover",
+          [](const geohash::Polygon& polygon, const uint32_t precision,
+             const size_t num_threads) -> std::tuple<py::array, py::array> {
+            check_range(precision);
+            return geohash::string::polygon_cover(polygon, precision,
+                                                  num_threads);
+          },
+          py::arg("polygon"), py::arg("precision") = 1,
+          py::arg("num_threads") = 0,
+          "Returns the sorted geohash of the cells within the polygon and of "
+          "the cells crossing its boundary. ValueError is raised if an edge "
+          "of the polygon crosses the antimeridian. num_threads is the number "
+          "of threads used, 0 selects the default number of threads.")
+      .def(
+          "circle_cover",
+          [](const geohash::Point& center, const double radius,
+             const uint32_t precision, const size_t num_threads)
+              -> std::tuple<py::array, Eigen::Matrix<double, -1, 1>,
+                            Eigen::Matrix<double, -1, 1>> {
+            check_range(precision);
+            return geohash::string::circle_cover(center, radius, precision,
+                                                 num_threads);
+          },
+          py::arg("center"), py::arg("radius"), py::arg("precision") = 1,
+          py::arg("num_threads") = 0,
+          "Returns the geohash of the cells within radius meters of the "
+          "center, sorted by increasing distance, and the minimum and "
+          "maximum great-circle distances, in meters, between the center and "
+          "each cell. num_threads is the number of threads used, 0 selects "
+          "the default number of threads.")
+      .def("compact", &geohash::string::compact, py::arg("hashs"),
+           "Replaces recursively the complete groups of 32 geohash sharing "
+           "the same prefix by this prefix and returns the mixed-length cover "
+           "sorted along the Z-order curve.")
+      .def(
+          "expand",
+          [](const py::array& hashs, const uint32_t precision,
+             const size_t num_threads) -> py::array {
+            check_range(precision);
+            return geohash::string::expand(hashs, precision, num_threads);
+          },
+          py::arg("hashs"), py::arg("precision") = 1,
+          py::arg("num_threads") = 0,
+          "Returns all the geohash of the given precision covered by a "
+          "mixed-length cover. num_threads is the number of threads used, 0 "
+          "selects the default number of threads.")
+      .def(
+          "from_int64",
+          [](const Eigen::Ref<const Eigen::Matrix<uint64_t, -1, 1>>& hashs,
+             const uint32_t precision, const uint32_t bits,
+             const size_t num_threads) -> py::array {
+            check_range(precision);
+            return geohash::string::from_int64(hashs, bits, precision,
+                                               num_threads);
+          },
+          py::arg("hashs"), py::arg("precision") = 12, py::arg("bits") = 64,
+          py::arg("num_threads") = 0,
+          "Converts integer geohash of the given number of bits into geohash "
+          "of the given precision, truncated to their parent cells if the "
+          "codes hold more bits. num_threads is the number of threads used, 0 "
+          "selects the default number of threads.")
+      .def("to_int64", &geohash::string::to_int64, py::arg("hashs"),
+           py::arg("bits") = py::none(), py::arg("num_threads") = 0,
+           "Converts geohash into integer geohash of the given number of "
+           "bits, truncated to their parent cells if the geohash hold more "
+           "bits. By default, the codes hold 5 bits per character of the "
+           "array. num_threads is the number of threads used, 0 selects the "
+           "default number of threads.")
       .def(
           "neighbors",
           [](const py::str& hash) {
@@ -107,6 +295,29 @@ void init_string(py::module& m) {
           },
           py::arg("box"),
           "Returns all neighbors hash clockwise from north around northwest")
+      .def(
+          "neighbors",
+          [](const py::array& hashs, const bool unique,
+             const size_t num_threads) -> py::array {
+            return geohash::string::neighbors(hashs, unique, num_threads);
+          },
+          py::arg("hashs"), py::arg("unique") = false,
+          py::arg("num_threads") = 0,
+          "Returns the neighbors of each hash, one row per hash, clockwise "
+          "from north around northwest. If unique is true, the sorted union "
+          "of the neighbors is returned instead. num_threads is the number of "
+          "threads used, 0 selects the default number of threads.")
+      .def(
+          "k_ring",
+          [](const py::str& hash, const uint32_t k) {
+            auto buffer = parse_str(hash);
+            return geohash::string::k_ring(buffer.data(), buffer.length(), k);
+          },
+          py::arg("hash"), py::arg("k") = 1,
+          "Returns all the geohash within the Chebyshev distance k of hash: "
+          "the hash itself followed by the rings of distance 1 to k, each one "
+          "clockwise from north. k must not exceed the number of columns of "
+          "the grid at the precision of hash.")
       .def(
           "grid_properties",
           [](const geohash::Box& box,
@@ -118,18 +329,62 @@ void init_string(py::module& m) {
           "Returns the property of the grid covering the given box: geohash of "
           "the minimum corner point, number of boxes in longitudes and "
           "latitudes.")
+      .def("where", &geohash::string::where, py::arg("hash"),
+           py::arg("num_threads") = 0,
+           "Returns the distinct geohash of the grid, sorted, and the first "
+           "and last rows and the first and last columns of the pixels "
+           "holding each of them: (hashs, row_min, row_max, col_min, "
+           "col_max). num_threads is the number of threads used, 0 selects "
+           "the default number of threads.");
+
+  py::class_<geohash::string::Cover>(
+      m, "Cover",
+      "Iterates over the geohash covering a box, in row order, by chunks of "
+      "a fixed size without materializing the whole grid.")
+      .def(py::init([](const std::optional<geohash::Box>& box,
+                       const uint32_t precision, const size_t chunk_size) {
+             check_range(precision);
+             return geohash::string::Cover(box, precision, chunk_size);
+           }),
+           py::arg("box") = py::none(), py::arg("precision") = 1,
+           py::arg("chunk_size") = 1048576,
+           R"(Constructor
+
+Args:
+    box (geohash.Box, optional): the box to cover. Defaults to the whole
+        Earth.
+    precision (int): the number of characters of the geohash.
+    chunk_size (int): the number of geohash returned at each iteration.
+)")
+      .def("__len__", &geohash::string::Cover::size,
+           "Returns the number of geohash covering the box.")
+      .def_property_readonly("chunk_size",
+                             &geohash::string::Cover::chunk_size,
+                             "Number of geohash returned at each iteration")
+      .def_property("cursor", &geohash::string::Cover::cursor,
+                    &geohash::string::Cover::seek,
+                    "Index of the first geohash of the next chunk. Setting "
+                    "it resumes the iteration from this geohash.")
+      .def("__iter__",
+           [](geohash::string::Cover& self) -> geohash::string::Cover& {
+             return self;
+           })
+      .def("__next__",
+           [](geohash::string::Cover& self) -> py::array {
+             auto result = self.next(0);
+             if (result.size() == 0) {
+               throw py::stop_iteration();
+             }
+             return result;
+           })
       .def(
-          "where",
-          // We want to return an associative dictionary between bytes and
-          // tuples and not str and tuples.
-          [](const pybind11::array& hash) -> py::dict {
-            auto result = py::dict();
-            for (auto&& item : geohash::string::where(hash)) {
-              auto key = py::bytes(item.first);
-              result[key] = py::cast(item.second);
-            }
-            return result;
-          },
-          py::arg("hash"),
-          "Returns the start and end indexes of the different GeoHash boxes.");
+          "next",
+          [](geohash::string::Cover& self,
+             const size_t num_threads) -> py::array {
+            return self.next(num_threads);
+          },
+          py::arg("num_threads") = 0,
+          "Returns the geohash of the next chunk, or an empty array if all "
+          "the geohash have been returned. num_threads is the number of "
+          "threads used, 0 selects the default number of threads.");
 }
\ No newline at end of file
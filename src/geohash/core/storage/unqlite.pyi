@@ -18,16 +18,25 @@ class ProgrammingError(Exception):
 
 
 class CompressionType:
+    lz4: 'CompressionType'
     none: 'CompressionType'
     snappy: 'CompressionType'
+    zstd: 'CompressionType'
+
+
+class SerializationType:
+    native: 'SerializationType'
+    pickle: 'SerializationType'
 
 
 class Database:
     def __init__(self,
                  name: str,
                  mode: Optional[str] = None,
-                 compression_type: CompressionType = CompressionType.snappy
-                 ) -> None:
+                 compression_type: CompressionType = CompressionType.snappy,
+                 serialization_type: SerializationType = SerializationType.
+                 pickle,
+                 compression_level: int = 0) -> None:
         ...
 
     def __getstate__(self) -> Tuple:
@@ -57,6 +66,12 @@ class Database:
     def commit(self) -> None:
         ...
 
+    def consolidate(self,
+                    keys: Optional[List[bytes]] = None,
+                    batch_size: int = 16384,
+                    num_threads: int = 0) -> None:
+        ...
+
     def error_log(self) -> str:
         ...
 
@@ -69,8 +84,18 @@ class Database:
     def rollback(self) -> None:
         ...
 
-    def update(self, map: Dict[bytes, Any]) -> None:
+    def train_dictionary(self,
+                         keys: Optional[List[bytes]] = None,
+                         capacity: int = 112640) -> None:
+        ...
+
+    def update(self,
+               map: Dict[bytes, Any],
+               batch_size: int = 16384,
+               num_threads: int = 0) -> None:
         ...
 
-    def values(self, keys: Optional[List[bytes]] = None) -> List[Any]:
+    def values(self,
+               keys: Optional[List[bytes]] = None,
+               num_threads: int = 0) -> List[Any]:
         ...
@@ -1,14 +1,79 @@
-from typing import Optional, Tuple, overload
+from typing import Iterator, Optional, Tuple, overload
 import numpy
-from . import Point, Box
+from . import Point, Box, Polygon
 
 
+@overload
 def bounding_box(hash: str) -> Box:
     ...
 
 
+@overload
+def bounding_box(
+    hashs: numpy.ndarray[bytes],
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray, numpy.ndarray, numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+def bounding_box(hashs: numpy.ndarray[bytes],
+                 lng_min: numpy.ndarray,
+                 lat_min: numpy.ndarray,
+                 lng_max: numpy.ndarray,
+                 lat_max: numpy.ndarray,
+                 num_threads: int = 0) -> None:
+    ...
+
+
+@overload
 def bounding_boxes(box: Optional[Box] = None,
-                   precision: int = 1) -> numpy.ndarray[bytes]:
+                   precision: int = 1,
+                   num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+@overload
+def bounding_boxes(polygon: Polygon,
+                   precision: int = 1,
+                   num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+def polygon_cover(polygon: Polygon,
+                  precision: int = 1,
+                  num_threads: int = 0) -> Tuple[numpy.ndarray[bytes], numpy.ndarray[bytes]]:
+    ...
+
+
+def circle_cover(
+        center: Point,
+        radius: float,
+        precision: int = 1,
+        num_threads: int = 0
+) -> Tuple[numpy.ndarray[bytes], numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+def compact(hashs: numpy.ndarray[bytes]) -> numpy.ndarray[bytes]:
+    ...
+
+
+def expand(hashs: numpy.ndarray[bytes],
+           precision: int = 1,
+           num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+def from_int64(hashs: numpy.ndarray,
+               precision: int = 12,
+               bits: int = 64,
+               num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+def to_int64(hashs: numpy.ndarray[bytes],
+             bits: Optional[int] = None,
+             num_threads: int = 0) -> numpy.ndarray:
     ...
 
 
@@ -18,7 +83,24 @@ def decode(hash: str, round: bool = False) -> Point:
 
 
 def decode(hashs: numpy.ndarray[bytes],
-           round: bool = False) -> numpy.ndarray[Point]:
+           round: bool = False,
+           num_threads: int = 0) -> numpy.ndarray[Point]:
+    ...
+
+
+@overload
+def decode_lnglat(
+        hashs: numpy.ndarray[bytes],
+        round: bool = False,
+        num_threads: int = 0) -> Tuple[numpy.ndarray, numpy.ndarray]:
+    ...
+
+
+def decode_lnglat(hashs: numpy.ndarray[bytes],
+                  lng: numpy.ndarray,
+                  lat: numpy.ndarray,
+                  round: bool = False,
+                  num_threads: int = 0) -> None:
     ...
 
 
@@ -27,8 +109,17 @@ def encode(point: Point, precision: int = 12) -> bytes:
     ...
 
 
+@overload
 def encode(points: numpy.ndarray[Point],
-           precision: int = 12) -> numpy.ndarray[bytes]:
+           precision: int = 12,
+           num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+def encode(lng: numpy.ndarray,
+           lat: numpy.ndarray,
+           precision: int = 12,
+           num_threads: int = 0) -> numpy.ndarray[bytes]:
     ...
 
 
@@ -41,5 +132,58 @@ def grid_properties(box: Optional[Box] = None,
     ...
 
 
+def k_ring(hash: str, k: int = 1) -> numpy.ndarray[bytes]:
+    ...
+
+
+@overload
 def neighbors(box: str) -> numpy.ndarray[bytes]:
     ...
+
+
+@overload
+def neighbors(hashs: numpy.ndarray[bytes],
+              unique: bool = False,
+              num_threads: int = 0) -> numpy.ndarray[bytes]:
+    ...
+
+
+class Cover:
+    def __init__(self,
+                 box: Optional[Box] = None,
+                 precision: int = 1,
+                 chunk_size: int = 1048576) -> None:
+        ...
+
+    def __iter__(self) -> Iterator[numpy.ndarray[bytes]]:
+        ...
+
+    def __len__(self) -> int:
+        ...
+
+    def __next__(self) -> numpy.ndarray[bytes]:
+        ...
+
+    @property
+    def chunk_size(self) -> int:
+        ...
+
+    @property
+    def cursor(self) -> int:
+        ...
+
+    @cursor.setter
+    def cursor(self, cursor: int) -> None:
+        ...
+
+    def next(self, num_threads: int = 0) -> numpy.ndarray[bytes]:
+        ...
+
+
+def where(
+    hash: numpy.ndarray[bytes],
+    num_threads: int = 0
+) -> Tuple[numpy.ndarray[bytes], numpy.ndarray[numpy.int64],
+           numpy.ndarray[numpy.int64], numpy.ndarray[numpy.int64],
+           numpy.ndarray[numpy.int64]]:
+    ...
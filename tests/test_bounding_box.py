@@ -1,3 +1,5 @@
+import numpy as np
+import pytest
 import geohash.core
 
 decodecases = [
@@ -4106,3 +4108,270 @@ def test_bbox():
         assert geohash.core.Box(geohash.core.Point(min_lng, min_lat),
                                 geohash.core.Point(max_lng,
                                                    max_lat)).contains(point)
+
+
+def test_batch_bbox():
+    hashs = np.array([item[0] for item in decodecases], dtype="S12")
+    lng_min, lat_min, lng_max, lat_max = geohash.core.string.bounding_box(
+        hashs)
+    for ix, item in enumerate(decodecases):
+        box = geohash.core.string.bounding_box(item[0])
+        assert lng_min[ix] == box.min_corner.lng
+        assert lat_min[ix] == box.min_corner.lat
+        assert lng_max[ix] == box.max_corner.lng
+        assert lat_max[ix] == box.max_corner.lat
+
+    hashs = np.random.randint(0, 2**63, size=1027, dtype="uint64")
+    kernel = geohash.core.kernel()
+    try:
+        for item in geohash.core.kernels():
+            geohash.core.set_kernel(item)
+            for precision in [1, 5, 32, 63]:
+                codes = hashs >> np.uint64(64 - precision)
+                lng_min, lat_min, lng_max, lat_max = \
+                    geohash.core.int64.bounding_box(codes, precision)
+                boxes = np.empty((codes.size, 4))
+                geohash.core.int64.bounding_box(codes, boxes[:, 0],
+                                                boxes[:, 1], boxes[:, 2],
+                                                boxes[:, 3], precision)
+                assert np.all(boxes[:, 0] == lng_min)
+                assert np.all(boxes[:, 3] == lat_max)
+                for ix, code in enumerate(codes):
+                    box = geohash.core.int64.bounding_box(int(code), precision)
+                    assert lng_min[ix] == box.min_corner.lng
+                    assert lat_min[ix] == box.min_corner.lat
+                    assert lng_max[ix] == box.max_corner.lng
+                    assert lat_max[ix] == box.max_corner.lat
+    finally:
+        geohash.core.set_kernel(kernel)
+
+
+def test_bounding_boxes():
+    box = geohash.core.Box(geohash.core.Point(170, -10),
+                           geohash.core.Point(-170, 10))
+    for precision in [3, 10, 15]:
+        codes = geohash.core.int64.bounding_boxes(box, precision)
+        # Each code is the cell containing the center of the cell found.
+        decoded = geohash.core.int64.decode(codes, precision)
+        assert np.all(
+            geohash.core.int64.encode(decoded, precision) == codes)
+        assert np.unique(codes).size == codes.size
+
+    hashs = geohash.core.string.bounding_boxes(box, 2)
+    codes = geohash.core.int64.bounding_boxes(box, 10)
+    assert np.all(hashs == geohash.core.string.encode(
+        geohash.core.int64.decode(codes, 10), 2))
+
+
+def test_cover():
+    box = geohash.core.Box(geohash.core.Point(170, -10),
+                           geohash.core.Point(-170, 10))
+    codes = geohash.core.int64.bounding_boxes(box, 25)
+    cover = geohash.core.int64.Cover(box, 25, chunk_size=1000)
+    assert len(cover) == codes.size
+    chunks = list(cover)
+    assert all(item.size == 1000 for item in chunks[:-1])
+    assert np.all(np.concatenate(chunks) == codes)
+    assert cover.cursor == codes.size
+    assert cover.next().size == 0
+
+    # Resume the iteration from a saved cursor.
+    cover.cursor = 1234
+    assert np.all(cover.next() == codes[1234:2234])
+    with pytest.raises(IndexError):
+        cover.cursor = codes.size + 1
+
+    hashs = geohash.core.string.bounding_boxes(box, 4)
+    cover = geohash.core.string.Cover(box, 4, chunk_size=1000)
+    assert len(cover) == hashs.size
+    assert np.all(np.concatenate(list(cover)) == hashs)
+
+
+def test_polygon_cover():
+    polygon = geohash.core.Polygon.read_wkt(
+        "POLYGON((0 0,10 0,10 10,5 5,0 10,0 0))")
+    inside, boundary = geohash.core.int64.polygon_cover(polygon, 20)
+    assert np.all(np.diff(inside.astype(np.int64)) > 0)
+    assert np.intersect1d(inside, boundary).size == 0
+    codes = geohash.core.int64.bounding_boxes(polygon, 20)
+    assert np.all(codes == np.union1d(inside, boundary))
+
+    # All the cells found are inside the envelope of the polygon.
+    envelope = geohash.core.int64.bounding_boxes(
+        geohash.core.Box(geohash.core.Point(0, 0),
+                         geohash.core.Point(10, 10)), 20)
+    assert np.all(np.isin(codes, envelope))
+    assert codes.size < envelope.size
+
+    lng, lat = geohash.core.int64.decode_lnglat(inside, 20)
+    assert np.all(lat <= 5 + np.abs(lng - 5))
+
+    hashs = geohash.core.string.bounding_boxes(polygon, 4)
+    assert np.all(hashs == geohash.core.string.encode(
+        geohash.core.int64.decode(
+            geohash.core.int64.bounding_boxes(polygon, 20), 20), 4))
+
+
+def test_polygon_antimeridian():
+    # The edges from 179 to -179 degrees would go around the globe.
+    polygon = geohash.core.Polygon.read_wkt(
+        "POLYGON((179 -1,-179 -1,-179 1,179 1,179 -1))")
+    with pytest.raises(ValueError):
+        geohash.core.int64.polygon_cover(polygon, 20)
+    with pytest.raises(ValueError):
+        geohash.core.int64.bounding_boxes(polygon, 20)
+    with pytest.raises(ValueError):
+        geohash.core.int64.range_cover(polygon, 20)
+    with pytest.raises(ValueError):
+        geohash.core.string.bounding_boxes(polygon, 4)
+    with pytest.raises(ValueError):
+        geohash.core.PreparedPolygon(polygon)
+
+    # Split at the antimeridian, its parts are covered.
+    east = geohash.core.Polygon.read_wkt(
+        "POLYGON((179 -1,180 -1,180 1,179 1,179 -1))")
+    west = geohash.core.Polygon.read_wkt(
+        "POLYGON((-180 -1,-179 -1,-179 1,-180 1,-180 -1))")
+    lng, _ = geohash.core.int64.decode_lnglat(
+        np.union1d(geohash.core.int64.bounding_boxes(east, 20),
+                   geohash.core.int64.bounding_boxes(west, 20)), 20)
+    assert np.all(np.abs(lng) >= 178.9)
+
+
+def test_compact():
+    box = geohash.core.Box(geohash.core.Point(-10, -5),
+                           geohash.core.Point(30, 20))
+    codes = geohash.core.int64.bounding_boxes(box, 25)
+    compacted, precisions = geohash.core.int64.compact(codes, 25)
+    assert compacted.size < codes.size // 10
+    assert set(precisions) <= {5, 10, 15, 20, 25}
+    assert np.all(
+        geohash.core.int64.expand(compacted, precisions, 25) == np.sort(
+            codes))
+    # The compaction of a compact cover is the cover itself.
+    other, _ = geohash.core.int64.compact(compacted, precisions)
+    assert np.all(other == compacted)
+    with pytest.raises(ValueError):
+        geohash.core.int64.expand(compacted, precisions, 20)
+
+    hashs = geohash.core.string.bounding_boxes(box, 5)
+    compacted = geohash.core.string.compact(hashs)
+    assert compacted.dtype == np.dtype("S5")
+    assert compacted.size < hashs.size // 10
+    assert np.all(
+        geohash.core.string.expand(compacted, 5) == np.sort(hashs))
+
+
+def test_range_cover():
+    box = geohash.core.Box(geohash.core.Point(170, -10),
+                           geohash.core.Point(-170, 10))
+    codes = np.sort(geohash.core.int64.bounding_boxes(box, 20))
+    ranges = geohash.core.int64.range_cover(box, 20)
+    assert ranges.shape[1] == 2
+    assert np.all(ranges[1:, 0] > ranges[:-1, 1])
+    assert np.all(
+        np.concatenate([np.arange(start, end, dtype=np.uint64)
+                        for start, end in ranges]) == codes)
+
+    # A limited number of intervals covers a superset of the cells.
+    limited = geohash.core.int64.range_cover(box, 20, max_ranges=4)
+    assert limited.shape[0] <= 4
+    index = np.searchsorted(limited[:, 0], codes, side="right") - 1
+    assert np.all(codes < limited[index, 1])
+
+    polygon = geohash.core.Polygon.read_wkt(
+        "POLYGON((0 0,10 0,10 10,5 5,0 10,0 0))")
+    ranges = geohash.core.int64.range_cover(polygon, 20)
+    assert np.all(
+        np.concatenate([np.arange(start, end, dtype=np.uint64)
+                        for start, end in ranges]) ==
+        geohash.core.int64.bounding_boxes(polygon, 20))
+
+
+def test_where():
+    lon = np.linspace(-10, 10, 70)
+    lat = np.linspace(-20, 20, 500)
+    mlon, mlat = np.meshgrid(lon, lat)
+    hashs = geohash.core.int64.encode(mlon.ravel(), mlat.ravel(),
+                                      10).reshape(mlon.shape)
+    codes, row_min, row_max, col_min, col_max = geohash.core.int64.where(
+        hashs)
+    assert np.all(codes == np.unique(hashs))
+    for ix, code in enumerate(codes):
+        rows, cols = np.where(hashs == code)
+        assert row_min[ix] == rows.min() and row_max[ix] == rows.max()
+        assert col_min[ix] == cols.min() and col_max[ix] == cols.max()
+
+    # The result does not depend on the number of threads.
+    other = geohash.core.int64.where(hashs, num_threads=4)
+    assert all(np.all(a == b) for a, b in zip(other, (codes, row_min, row_max,
+                                                      col_min, col_max)))
+
+    strs = geohash.core.string.encode(mlon.ravel(), mlat.ravel(),
+                                      2).reshape(mlon.shape)
+    hashs, row_min, row_max, col_min, col_max = geohash.core.string.where(
+        strs)
+    assert hashs.dtype == np.dtype("S2")
+    assert np.all(hashs == np.unique(strs))
+    # A geohash of two characters is an integer geohash of 10 bits.
+    assert np.all(
+        geohash.core.string.encode(geohash.core.int64.decode(codes, 10),
+                                   2) == hashs)
+    assert np.all(row_min == other[1]) and np.all(row_max == other[2])
+    assert np.all(col_min == other[3]) and np.all(col_max == other[4])
+
+
+def haversine(lng0, lat0, lng1, lat1):
+    lng0, lat0, lng1, lat1 = map(np.radians, (lng0, lat0, lng1, lat1))
+    h = np.sin((lat1 - lat0) / 2)**2 + np.cos(lat0) * np.cos(lat1) * np.sin(
+        (lng1 - lng0) / 2)**2
+    return 2 * np.arcsin(np.sqrt(h)) * 6371008.8
+
+
+def test_circle_cover():
+    # The circle crosses the antimeridian.
+    center = geohash.core.Point(179.9, 10)
+    radius = 200000
+    codes, min_distance, max_distance = geohash.core.int64.circle_cover(
+        center, radius, 20)
+    assert np.all(np.diff(min_distance) >= 0)
+    assert np.all(min_distance <= radius)
+    assert np.all(min_distance <= max_distance)
+    assert min_distance[0] == 0
+    assert codes[0] == geohash.core.int64.encode(center, 20)
+    assert np.unique(codes).size == codes.size
+
+    # The distances bound the distance to the center of the cells, and all
+    # the cells whose center is within the radius are found.
+    lng, lat = geohash.core.int64.decode_lnglat(codes, 20)
+    distance = haversine(center.lng, center.lat, lng, lat)
+    assert np.all(min_distance <= distance + 1e-6)
+    assert np.all(distance <= max_distance + 1e-6)
+    assert np.any(lng < 0) and np.any(lng > 0)
+    box = geohash.core.Box(geohash.core.Point(177, 7),
+                           geohash.core.Point(-177, 13))
+    candidates = geohash.core.int64.bounding_boxes(box, 20)
+    lng, lat = geohash.core.int64.decode_lnglat(candidates, 20)
+    within = candidates[haversine(center.lng, center.lat, lng, lat) <= radius]
+    assert np.all(np.isin(within, codes))
+    # The cover is much tighter than the box.
+    assert codes.size < candidates.size // 2
+
+    # Near a pole, the circle covers all the longitudes.
+    codes, _, _ = geohash.core.int64.circle_cover(
+        geohash.core.Point(0, 89.99), 10000, 10)
+    lng, _ = geohash.core.int64.decode_lnglat(codes, 10)
+    assert np.unique(lng).size == 32
+
+    hashs, min_distance, max_distance = geohash.core.string.circle_cover(
+        center, radius, 4)
+    assert hashs.dtype == np.dtype("S4")
+    codes, other_min, other_max = geohash.core.int64.circle_cover(
+        center, radius, 20)
+    assert np.all(min_distance == other_min)
+    assert np.all(max_distance == other_max)
+    assert np.all(
+        hashs == geohash.core.string.from_int64(codes, precision=4, bits=20))
+
+    with pytest.raises(ValueError):
+        geohash.core.int64.circle_cover(center, -1, 20)
@@ -1,4 +1,5 @@
 import numpy as np
+import pytest
 import geohash.core
 
 testcases = [
@@ -4117,3 +4118,261 @@ def test_encoding_decoding():
     decoded_points = geohash.core.string.decode(str_hashs, round=True)
     assert np.all(np.abs(points["lat"] - decoded_points["lat"]) < 1e-6)
     assert np.all(np.abs(points["lng"] - decoded_points["lng"]) < 1e-6)
+
+
+def test_batch_encoding():
+    dtype = np.dtype([("lng", "f8"), ("lat", "f8")])
+    # Odd number of points to check the handling of the items not processed
+    # by the vectorized kernels.
+    size = 1027
+    points = np.empty((size, ), dtype=dtype)
+    points["lng"] = np.random.uniform(-180, 180, size)
+    points["lat"] = np.random.uniform(-90, 90, size)
+    points["lat"][::7] = 90
+    points["lng"][::11] = 180
+    for precision in [1, 5, 32, 63, 64]:
+        hashs = geohash.core.int64.encode(points, precision)
+        for ix, item in enumerate(points):
+            point = geohash.core.Point(item["lng"], item["lat"])
+            assert hashs[ix] == geohash.core.int64.encode(point, precision)
+
+
+def test_multithreaded_encoding():
+    dtype = np.dtype([("lng", "f8"), ("lat", "f8")])
+    size = 100003
+    points = np.empty((size, ), dtype=dtype)
+    points["lng"] = np.random.uniform(-180, 180, size)
+    points["lat"] = np.random.uniform(-90, 90, size)
+
+    int_hashs = geohash.core.int64.encode(points, num_threads=1)
+    assert np.all(
+        geohash.core.int64.encode(points, num_threads=4) == int_hashs)
+    decoded = geohash.core.int64.decode(int_hashs, round=True, num_threads=1)
+    assert np.all(
+        geohash.core.int64.decode(int_hashs, round=True, num_threads=4) ==
+        decoded)
+
+    str_hashs = geohash.core.string.encode(points, num_threads=1)
+    assert np.all(
+        geohash.core.string.encode(points, num_threads=4) == str_hashs)
+    decoded = geohash.core.string.decode(str_hashs, num_threads=1)
+    assert np.all(
+        geohash.core.string.decode(str_hashs, num_threads=4) == decoded)
+
+    num_threads = geohash.core.get_num_threads()
+    try:
+        geohash.core.set_num_threads(3)
+        assert geohash.core.get_num_threads() == 3
+        assert np.all(geohash.core.int64.encode(points) == int_hashs)
+    finally:
+        geohash.core.set_num_threads(num_threads)
+
+
+def test_lnglat_encoding():
+    dtype = np.dtype([("lng", "f8"), ("lat", "f8")])
+    size = 1027
+    points = np.empty((size, ), dtype=dtype)
+    points["lng"] = np.random.uniform(-180, 180, size)
+    points["lat"] = np.random.uniform(-90, 90, size)
+
+    # Strided views on the fields of the structured array are not copied.
+    int_hashs = geohash.core.int64.encode(points)
+    assert np.all(
+        geohash.core.int64.encode(points["lng"], points["lat"]) == int_hashs)
+    lng = np.ascontiguousarray(points["lng"])
+    lat = np.ascontiguousarray(points["lat"])
+    assert np.all(geohash.core.int64.encode(lng, lat) == int_hashs)
+
+    lng32 = lng.astype("float32")
+    lat32 = lat.astype("float32")
+    points32 = np.empty((size, ), dtype=dtype)
+    points32["lng"] = lng32
+    points32["lat"] = lat32
+    assert np.all(
+        geohash.core.int64.encode(lng32, lat32) == geohash.core.int64.encode(
+            points32))
+
+    decoded = geohash.core.int64.decode(int_hashs, round=True)
+    lng, lat = geohash.core.int64.decode_lnglat(int_hashs, round=True)
+    assert np.all(decoded["lng"] == lng)
+    assert np.all(decoded["lat"] == lat)
+    lng32 = np.empty((size, ), dtype="float32")
+    lat32 = np.empty((size, ), dtype="float32")
+    geohash.core.int64.decode_lnglat(int_hashs, lng32, lat32, round=True)
+    assert np.all(decoded["lng"].astype("float32") == lng32)
+    assert np.all(decoded["lat"].astype("float32") == lat32)
+
+    str_hashs = geohash.core.string.encode(points)
+    assert np.all(
+        geohash.core.string.encode(points["lng"], points["lat"]) == str_hashs)
+    decoded = geohash.core.string.decode(str_hashs)
+    lng, lat = geohash.core.string.decode_lnglat(str_hashs)
+    assert np.all(decoded["lng"] == lng)
+    assert np.all(decoded["lat"] == lat)
+    geohash.core.string.decode_lnglat(str_hashs, lng32, lat32)
+    assert np.all(decoded["lng"].astype("float32") == lng32)
+
+
+def test_kernels():
+    dtype = np.dtype([("lng", "f8"), ("lat", "f8")])
+    points = np.array([(item[3], item[2]) for item in testcases], dtype=dtype)
+    expected = np.array([item[0] for item in testcases], dtype="uint64")
+    kernels = geohash.core.kernels()
+    assert "scalar" in kernels
+    assert geohash.core.kernel() in kernels
+
+    kernel = geohash.core.kernel()
+    try:
+        # All kernels return identical results.
+        for item in kernels:
+            geohash.core.set_kernel(item)
+            assert geohash.core.kernel() == item
+            assert np.all(geohash.core.int64.encode(points) == expected)
+            assert np.all(
+                geohash.core.int64.encode(points["lng"], points["lat"]) ==
+                expected)
+            decoded = geohash.core.int64.decode(expected, round=True)
+            assert np.all(np.abs(points["lat"] - decoded["lat"]) < 1e-7)
+            assert np.all(np.abs(points["lng"] - decoded["lng"]) < 1e-7)
+    finally:
+        geohash.core.set_kernel(kernel)
+
+    with pytest.raises(ValueError):
+        geohash.core.set_kernel("unknown")
+
+
+def test_batch_decoding():
+    hashs = np.array([item[0] for item in testcases], dtype="uint64")
+    hashs = np.concatenate((hashs, np.array([0, 2**64 - 1], dtype="uint64")))
+
+    kernel = geohash.core.kernel()
+    try:
+        for item in geohash.core.kernels():
+            geohash.core.set_kernel(item)
+            for precision in [1, 5, 12, 25, 32, 51, 63, 64]:
+                codes = hashs >> np.uint64(64 - precision)
+                for round in [False, True]:
+                    decoded = geohash.core.int64.decode(codes,
+                                                        precision=precision,
+                                                        round=round)
+                    for ix, code in enumerate(codes):
+                        point = geohash.core.int64.decode(int(code),
+                                                          precision=precision,
+                                                          round=round)
+                        assert decoded[ix]["lng"] == point.lng
+                        assert decoded[ix]["lat"] == point.lat
+    finally:
+        geohash.core.set_kernel(kernel)
+
+
+
+def test_base32_kernels():
+    dtype = np.dtype([("lng", "f8"), ("lat", "f8")])
+    points = np.array([(item[3], item[2]) for item in testcases], dtype=dtype)
+    expected = np.array([item[1] for item in testcases], dtype="S12")
+    # Mixed lengths, including the longest hashs decoded from their 13 bytes.
+    mixed = np.array(
+        [item[1][:(ix % 12) + 1] for ix, item in enumerate(testcases)],
+        dtype="S13")
+
+    kernel = geohash.core.kernel()
+    try:
+        for item in geohash.core.kernels():
+            geohash.core.set_kernel(item)
+            for precision in range(1, 13):
+                hashs = geohash.core.string.encode(points, precision=precision)
+                assert np.all(hashs == expected.astype(f"S{precision}"))
+                assert np.all(
+                    geohash.core.string.encode(points["lng"], points["lat"],
+                                               precision=precision) == hashs)
+            decoded = geohash.core.string.decode(mixed)
+            for ix, hash in enumerate(mixed):
+                point = geohash.core.string.decode(hash)
+                assert decoded[ix]["lng"] == point.lng
+                assert decoded[ix]["lat"] == point.lat
+
+            # Invalid characters are detected wherever they occur.
+            for ix in [0, len(expected) // 2, len(expected) - 1]:
+                invalid = expected.copy()
+                invalid[ix] = invalid[ix][:5] + b"a" + invalid[ix][6:]
+                with pytest.raises(ValueError):
+                    geohash.core.string.decode(invalid)
+    finally:
+        geohash.core.set_kernel(kernel)
+
+
+
+def test_transcoding():
+    codes = np.array([item[0] for item in testcases], dtype="uint64")
+    hashs = np.array([item[1] for item in testcases], dtype="S12")
+
+    # The 64-bit codes are truncated to the 60 bits of the GeoHash.
+    assert np.all(geohash.core.string.from_int64(codes) == hashs)
+    assert np.all(geohash.core.string.to_int64(hashs) == codes >> np.uint64(4))
+
+    for precision in range(1, 13):
+        expected = hashs.astype(f"S{precision}")
+        shifted = codes >> np.uint64(64 - 5 * precision)
+        assert np.all(
+            geohash.core.string.from_int64(
+                shifted, precision=precision, bits=5 * precision) == expected)
+        # Parent cells of the codes and of the GeoHash.
+        assert np.all(
+            geohash.core.string.from_int64(
+                codes >> np.uint64(4), precision=precision, bits=60) ==
+            expected)
+        assert np.all(
+            geohash.core.string.to_int64(hashs, bits=5 * precision) == shifted)
+        assert np.all(geohash.core.string.to_int64(expected) == shifted)
+
+    with pytest.raises(ValueError):
+        geohash.core.string.from_int64(codes, precision=12, bits=32)
+    with pytest.raises(ValueError):
+        geohash.core.string.to_int64(hashs, bits=61)
+    # Mixed lengths shorter than the precision requested.
+    with pytest.raises(ValueError):
+        geohash.core.string.to_int64(np.array([b"sb54v", b"sb"]), bits=25)
+    assert np.all(
+        geohash.core.string.to_int64(np.array([b"sb54v", b"sb"]), bits=10) ==
+        geohash.core.string.to_int64(np.array([b"sb", b"sb"])))
+
+
+def test_strided_views():
+    hashs = np.array([item[1] for item in testcases], dtype="S12")
+    string = geohash.core.string
+    # The views which are not contiguous are decoded like their copy.
+    for view in [hashs[::-1], hashs[::2], hashs.astype("S6")[::-3]]:
+        copy = view.copy()
+        assert np.all(string.decode(view) == string.decode(copy))
+        assert np.all(string.to_int64(view) == string.to_int64(copy))
+        for item, expected in zip(string.bounding_box(view),
+                                  string.bounding_box(copy)):
+            assert np.all(item == expected)
+    matrix = hashs.astype("S3")[:24].reshape(4, 6)
+    for item, expected in zip(string.where(matrix.T),
+                              string.where(matrix.T.copy())):
+        assert np.all(item == expected)
+
+
+def test_argsort():
+    lng = np.random.uniform(-180, 180, 100000)
+    lat = np.random.uniform(-90, 90, 100000)
+    for precision in [20, 64]:
+        codes = geohash.core.int64.encode(lng, lat, precision)
+        expected = np.argsort(codes, kind="stable")
+        permutation, sorted_codes = geohash.core.int64.argsort(
+            lng, lat, precision)
+        assert np.all(permutation == expected)
+        assert np.all(sorted_codes == codes[expected])
+        permutation, sorted_codes = geohash.core.int64.argsort(
+            codes, precision, num_threads=4)
+        assert np.all(permutation == expected)
+
+    values = np.vstack((lng, lat)).T.copy()
+    geohash.core.int64.permute(values, permutation)
+    assert np.all(values[:, 0] == lng[permutation])
+    assert np.all(values[:, 1] == lat[permutation])
+    geohash.core.int64.permute(lng, permutation)
+    assert np.all(lng == values[:, 0])
+    with pytest.raises(IndexError):
+        geohash.core.int64.permute(lat, permutation + 1)
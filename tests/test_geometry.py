@@ -41,3 +41,54 @@ def test_polygon():
     polygon = geohash.Polygon.read_wkt(
         "POLYGON((0 0,0 5,5 5,5 0,0 0),(1 1,4 1,4 4,1 4,1 1))")
     assert isinstance(polygon, geohash.Polygon)
+
+
+def test_box_contains():
+    points = np.empty((1000, ), dtype=geohash.POINT_DTYPE)
+    points["lng"] = np.random.uniform(-180, 180, points.size)
+    points["lat"] = np.random.uniform(-90, 90, points.size)
+    points[7] = (np.nan, 0)
+
+    for box in [
+            geohash.Box(geohash.Point(-10, -5), geohash.Point(20, 30)),
+            # The box wraps around the antimeridian.
+            geohash.Box(geohash.Point(170, -10), geohash.Point(-170, 10))
+    ]:
+        expected = np.array([
+            box.contains(geohash.Point(lng, lat))
+            for lng, lat in zip(points["lng"], points["lat"])
+        ])
+        assert np.all(box.contains(points) == expected)
+        assert np.all(box.contains(points["lng"], points["lat"]) == expected)
+        lng32 = points["lng"].astype("float32")
+        lat32 = points["lat"].astype("float32")
+        points32 = np.empty_like(points)
+        points32["lng"] = lng32
+        points32["lat"] = lat32
+        assert np.all(box.contains(lng32, lat32) == box.contains(points32))
+    box = geohash.Box(geohash.Point(170, -10), geohash.Point(-170, 10))
+    assert box.contains(geohash.Point(175, 0))
+    assert box.contains(geohash.Point(-175, 0))
+    assert not box.contains(geohash.Point(0, 0))
+
+
+def test_prepared_polygon():
+    polygon = geohash.Polygon.read_wkt(
+        "POLYGON((0 0,10 0,10 10,5 5,0 10,0 0),(2 1,4 1,4 3,2 3,2 1))")
+    prepared = geohash.PreparedPolygon(polygon)
+    assert str(prepared.envelope()) == "geohash.Box((0, 0), (10, 10))"
+
+    points = np.empty((10000, ), dtype=geohash.POINT_DTYPE)
+    points["lng"] = np.random.uniform(-1, 11, points.size)
+    points["lat"] = np.random.uniform(-1, 11, points.size)
+    lng, lat = points["lng"], points["lat"]
+    # Inside the outer ring, below the notch, outside the hole.
+    expected = ((lng > 0) & (lng < 10) & (lat > 0) &
+                (lat < 5 + np.abs(lng - 5)) &
+                ~((lng > 2) & (lng < 4) & (lat > 1) & (lat < 3)))
+    mask = prepared.contains(points)
+    assert np.all(mask == expected)
+    assert np.all(prepared.contains(lng, lat) == expected)
+    assert prepared.contains(geohash.Point(1, 1))
+    assert not prepared.contains(geohash.Point(3, 2))
+    assert not prepared.contains(geohash.Point(5, 8))
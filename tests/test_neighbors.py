@@ -1,4 +1,5 @@
 import numpy as np
+import pytest
 import geohash.core
 
 cases = [
@@ -10339,3 +10340,75 @@ def test_neighbors():
         assert hash_str == hash.astype("U")
         assert list(geohash.core.string.neighbors(hash_str).astype(
             "U")) == hash_str_neighbors
+        assert list(geohash.core.int64.k_ring(
+            hash_int, 1, bits)) == [hash_int] + hash_int_neighbors
+        assert list(geohash.core.string.k_ring(
+            hash_str, 1).astype("U")) == [hash_str] + hash_str_neighbors
+
+
+def test_batch_neighbors():
+    for bits in [1, 2, 25, 36, 63, 64]:
+        hashs = np.random.randint(0, 2**min(bits, 63), 64, dtype="uint64")
+        result = geohash.core.int64.neighbors(hashs, bits)
+        assert result.shape == (len(hashs), 8)
+        for ix, item in enumerate(hashs):
+            assert np.all(
+                result[ix] == geohash.core.int64.neighbors(int(item), bits))
+
+        result = geohash.core.int64.k_ring(hashs, 2, bits)
+        assert result.shape == (len(hashs), 25)
+        for ix, item in enumerate(hashs):
+            assert np.all(
+                result[ix] == geohash.core.int64.k_ring(int(item), 2, bits))
+        assert np.all(result[:, 1:9] == geohash.core.int64.neighbors(
+            hashs, bits))
+
+
+
+def test_batch_string_neighbors():
+    # Mixed lengths in the same array.
+    hashs = np.array([item[5] for item in cases], dtype="S")
+    result = geohash.core.string.neighbors(hashs)
+    assert result.shape == (len(hashs), 8)
+    assert result.dtype == hashs.dtype
+    for ix, item in enumerate(cases):
+        assert list(result[ix].astype("U")) == item[6]
+
+    unique = geohash.core.string.neighbors(np.concatenate((hashs, hashs)),
+                                           unique=True)
+    assert unique.dtype == hashs.dtype
+    assert list(unique) == sorted(set(result.ravel()))
+
+    assert geohash.core.string.neighbors(hashs[:0]).shape == (0, 8)
+    with pytest.raises(ValueError):
+        geohash.core.string.neighbors(np.array([b"sb54a"]))
+
+
+def test_neighbors_edges():
+    # Longitudes wrap around the antimeridian.
+    east = geohash.core.string.neighbors("x")
+    assert east[2] == b"8"
+    west = geohash.core.string.neighbors("8")
+    assert west[6] == b"x"
+    # Latitudes saturate at the poles.
+    north = geohash.core.string.neighbors("zz")
+    assert north[0] == b"zz"
+    assert north[1] == b"bp"
+    south = geohash.core.string.neighbors("00")
+    assert south[4] == b"00"
+    assert south[5] == b"pb"
+
+    ring = geohash.core.string.k_ring("s0", 2)
+    assert len(ring) == 25
+    assert len(set(ring)) == 25
+
+    # The rings cannot be wider than the grid.
+    assert len(geohash.core.int64.k_ring(0, 2, 1)) == 25
+    with pytest.raises(ValueError):
+        geohash.core.int64.k_ring(0, 3, 1)
+    with pytest.raises(ValueError):
+        geohash.core.int64.k_ring(np.array([0], dtype="uint64"), 3, 1)
+    with pytest.raises(ValueError):
+        geohash.core.int64.k_ring(0, 2**32 - 1, 64)
+    with pytest.raises(ValueError):
+        geohash.core.string.k_ring("s", 33)
@@ -2,6 +2,7 @@ import tempfile
 import pickle
 import shutil
 import pytest
+import numpy
 from geohash.core.storage import unqlite
 from geohash.core import string
 
@@ -78,6 +79,224 @@ def test_interface():
         shutil.rmtree(target, ignore_errors=True)
 
 
+def test_update():
+    target = tempfile.NamedTemporaryFile().name
+    try:
+        handler = unqlite.Database(target, mode="w")
+        data = dict((str(item).encode(), [item, str(item)])
+                    for item in range(1000))
+
+        # Values written in several transactions by several threads.
+        handler.update(data, batch_size=64, num_threads=4)
+        assert len(handler) == 1000
+        for key, value in data.items():
+            assert handler[key] == value
+
+        # Values overwritten in a single transaction
+        handler.update(dict((key, None) for key in data), num_threads=1)
+        assert handler.values(list(data.keys())) == [[None]] * 1000
+
+        with pytest.raises(ValueError):
+            handler.update(data, batch_size=0)
+
+        # Nothing is written if a key is invalid
+        with pytest.raises(RuntimeError):
+            handler.update({b"a": 1, "b": 2})
+        assert b"a" not in handler
+
+        # Each batch is committed: rollback does not undo the update, and
+        # the batches written before an error remain in the database.
+        handler.update({b"a": 1})
+        handler.rollback()
+        assert handler[b"a"] == [1]
+        with pytest.raises(Exception):
+            handler.update({b"b": 2, b"c": lambda: None}, batch_size=1)
+        assert handler[b"b"] == [2]
+        assert b"c" not in handler
+
+        del handler
+    finally:
+        shutil.rmtree(target, ignore_errors=True)
+
+
+def test_values():
+    handler = unqlite.Database(":mem:", mode="w")
+    data = dict((str(item).encode(), [item, b"#" * item])
+                for item in range(1000))
+    handler.update(data)
+
+    keys = [str(item).encode() for item in range(999, -1, -1)] + [b"none"]
+    for num_threads in [1, 4]:
+        values = handler.values(keys, num_threads=num_threads)
+        assert values[:-1] == [data[key] for key in keys[:-1]]
+        # Missing key
+        assert values[-1] == []
+
+    assert len(handler.values()) == 1000
+    assert handler.values([]) == []
+    with pytest.raises(RuntimeError):
+        handler.values(["0"])
+
+
+def test_extend():
+    handler = unqlite.Database(":mem:", mode="w")
+    keys = [str(item).encode() for item in range(100)]
+    handler.update(dict((key, 0) for key in keys))
+
+    # Each call appends a block of values to the records.
+    for item in range(1, 10):
+        handler.extend(dict((key, [item, str(item)]) for key in keys))
+    handler.extend({b"new": [1, 2]})
+    expected = [0] + sum([[item, str(item)] for item in range(1, 10)], [])
+    assert handler[keys[0]] == expected
+    assert handler.values(keys) == [expected] * 100
+    assert handler[b"new"] == [1, 2]
+
+    # The blocks are merged into one.
+    handler.consolidate(keys[:50], batch_size=16, num_threads=2)
+    assert handler.values(keys) == [expected] * 100
+    handler.consolidate()
+    assert handler.values(keys) == [expected] * 100
+    assert len(handler) == 101
+
+    handler.extend({keys[0]: "#"})
+    assert handler[keys[0]] == expected + ["#"]
+
+
+def test_native_serialization():
+    target = tempfile.NamedTemporaryFile().name
+    try:
+        handler = unqlite.Database(
+            target,
+            mode="w",
+            serialization_type=unqlite.SerializationType.native)
+        matrix = numpy.arange(60, dtype="float64").reshape(6, 10)
+        arrays = [
+            numpy.arange(10),
+            numpy.asfortranarray(matrix),
+            matrix[::2, 1::3],
+            numpy.array([1, 2, 3], dtype=">i4"),
+            numpy.array([b"abc", b"d"]),
+            numpy.array(3.5),
+            numpy.empty((0, 3)),
+        ]
+        handler[b"arrays"] = arrays
+        handler[b"tuple"] = (arrays[0], arrays[2])
+        # Values not handled by the native codec are pickled.
+        handler[b"pickle"] = [numpy.array([None, 1]), "abc"]
+        handler.extend({b"arrays": matrix, b"pickle": 1})
+
+        values = handler[b"arrays"]
+        assert len(values) == len(arrays) + 1
+        for item, expected in zip(values, arrays + [matrix]):
+            assert isinstance(item, numpy.ndarray)
+            assert item.dtype == expected.dtype
+            assert numpy.all(item == expected)
+        assert values[1].flags.f_contiguous
+
+        values = handler[b"tuple"]
+        assert len(values) == 1
+        assert isinstance(values[0], tuple)
+        assert numpy.all(values[0][1] == arrays[2])
+
+        values = handler[b"pickle"]
+        assert values[0].dtype == object
+        assert values[1:] == ["abc", 1]
+
+        # The serialization is preserved by pickle.
+        handler = pickle.loads(pickle.dumps(handler))
+        handler[b"1"] = numpy.ones(10)
+        assert numpy.all(handler.values([b"1"])[0][0] == 1)
+        del handler
+    finally:
+        shutil.rmtree(target, ignore_errors=True)
+
+
+def test_compression():
+    target = tempfile.NamedTemporaryFile().name
+    data = dict((str(item).encode(), ["#" * item, item]) for item in range(64))
+    try:
+        # Each compression writes its own keys in the same database.
+        compressions = [(unqlite.CompressionType.none, 0),
+                        (unqlite.CompressionType.snappy, 0),
+                        (unqlite.CompressionType.lz4, 0),
+                        (unqlite.CompressionType.lz4, 9),
+                        (unqlite.CompressionType.zstd, 0),
+                        (unqlite.CompressionType.zstd, -5),
+                        (unqlite.CompressionType.zstd, 19)]
+        for ix, (compression_type, level) in enumerate(compressions):
+            handler = unqlite.Database(target,
+                                       mode="w" if ix == 0 else "a",
+                                       compression_type=compression_type,
+                                       compression_level=level)
+            handler.update(
+                dict((key + b"_" + str(ix).encode(), value)
+                     for key, value in data.items()))
+            handler.extend({b"0_0": ix})
+            handler.commit()
+            del handler
+
+        handler = unqlite.Database(target)
+        assert len(handler) == len(data) * len(compressions)
+        for ix in range(len(compressions)):
+            for key, value in data.items():
+                expected = value + list(range(len(compressions))) if (
+                    key == b"0" and ix == 0) else value
+                assert handler[key + b"_" + str(ix).encode()] == expected
+        del handler
+
+        with pytest.raises(ValueError):
+            unqlite.Database(":mem:",
+                             mode="w",
+                             compression_type=unqlite.CompressionType.lz4,
+                             compression_level=13)
+    finally:
+        shutil.rmtree(target, ignore_errors=True)
+
+
+def test_dictionary():
+    target = tempfile.NamedTemporaryFile().name
+    data = dict((str(item).encode(),
+                 ["file_%08d.nc" % (item + jx) for jx in range(8)])
+                for item in range(2048))
+    keys = list(data.keys())
+    try:
+        handler = unqlite.Database(
+            target, mode="w", compression_type=unqlite.CompressionType.zstd)
+        handler.update(dict((key, data[key]) for key in keys[:1024]))
+        handler.train_dictionary(capacity=4096)
+        # The dictionary is hidden
+        assert len(handler) == 1024
+        assert set(handler.keys()) == set(keys[:1024])
+
+        # The new values are compressed with the dictionary.
+        handler.update(dict((key, data[key]) for key in keys[1024:]))
+        handler.train_dictionary(keys[1024:], capacity=4096)
+        handler.extend({keys[0]: "new"})
+        handler.commit()
+        del handler
+
+        handler = unqlite.Database(target)
+        assert len(handler) == 2048
+        assert handler.values(keys[1:]) == [data[key] for key in keys[1:]]
+        assert handler[keys[0]] == data[keys[0]] + ["new"]
+        del handler
+
+        handler = unqlite.Database(target, mode="a")
+        handler.clear()
+        assert len(handler) == 0
+        del handler
+
+        # Only the databases compressed with Zstandard use a dictionary.
+        handler = unqlite.Database(target, mode="w")
+        handler.update(dict((key, data[key]) for key in keys[:1024]))
+        with pytest.raises(unqlite.ProgrammingError):
+            handler.train_dictionary(capacity=4096)
+        del handler
+    finally:
+        shutil.rmtree(target, ignore_errors=True)
+
+
 def test_big_data():
     """Simulation of a GeoHash grid database. The database contains for each
     box a list of 10 dummy filenames.